@@ -39,21 +39,54 @@ gcc -Wall -Wextra -O2 -c src/main.c -o src/main.o
 echo -e "${WHITE}   bmp_handler.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -c src/bmp_handler/bmp_handler.c -o src/bmp_handler/bmp_handler.o
 
+echo -e "${WHITE}   bmp_stream.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -c src/bmp_handler/bmp_stream.c -o src/bmp_handler/bmp_stream.o
+
+echo -e "${WHITE}   bmp_cache.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -Isrc -Isrc/bmp_handler -Isrc/common -c src/bmp_handler/bmp_cache.c -o src/bmp_handler/bmp_cache.o
+
 echo -e "${WHITE}   bmp_image.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -c src/common/bmp_image.c -o src/common/bmp_image.o
 
+echo -e "${WHITE}   cpu_features.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/common -c src/common/cpu_features.c -o src/common/cpu_features.o
+
 echo -e "${WHITE}   lsb1.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsb1 -c src/lsb1/lsb1.c -o src/lsb1/lsb1.o
 
+echo -e "${WHITE}   lsb1_simd.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/lsb1 -c src/lsb1/lsb1_simd.c -o src/lsb1/lsb1_simd.o
+
 echo -e "${WHITE}   lsb4.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsb4 -c src/lsb4/lsb4.c -o src/lsb4/lsb4.o
 
+echo -e "${WHITE}   lsb4_simd.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/lsb4 -c src/lsb4/lsb4_simd.c -o src/lsb4/lsb4_simd.o
+
 echo -e "${WHITE}   lsbi.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsbi -Isrc/lsb1 -c src/lsbi/lsbi.c -o src/lsbi/lsbi.o
 
+echo -e "${WHITE}   lsbi_simd.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/lsbi -c src/lsbi/lsbi_simd.c -o src/lsbi/lsbi_simd.o
+
+echo -e "${WHITE}   lsbn.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsbn -Isrc/lsb1 -Isrc/lsb4 -c src/lsbn/lsbn.c -o src/lsbn/lsbn.o
+
+echo -e "${WHITE}   steg_stream.c${NC}"
+gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsb1 -Isrc/lsb4 -Isrc/lsbi -Isrc/lsbn -Isrc/utils/parser -Isrc/utils/thread_pool -c src/steg_stream/steg_stream.c -o src/steg_stream/steg_stream.o
+
 echo -e "${WHITE}   file_management.c${NC}"
 gcc -Wall -Wextra -O2 -c src/utils/file_management/file_management.c -o src/utils/file_management/file_management.o
 
+echo -e "${WHITE}   payload_source.c${NC}"
+gcc -Wall -Wextra -O2 -c src/utils/payload_source/payload_source.c -o src/utils/payload_source/payload_source.o
+
+echo -e "${WHITE}   thread_pool.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -c src/utils/thread_pool/thread_pool.c -o src/utils/thread_pool/thread_pool.o
+
+echo -e "${WHITE}   chunk_ring.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -c src/utils/chunk_ring/chunk_ring.c -o src/utils/chunk_ring/chunk_ring.o
+
 echo -e "${WHITE}   parser.c${NC}"
 gcc -Wall -Wextra -O2 -c src/utils/parser/parser.c -o src/utils/parser/parser.o
 
@@ -61,11 +94,20 @@ echo -e "${WHITE}   translator.c${NC}"
 gcc -Wall -Wextra -O2 -c src/utils/translator/translator.c -o src/utils/translator/translator.o
 
 echo -e "${WHITE}   operations.c${NC}"
-gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsb1 -Isrc/lsb4 -Isrc/lsbi -Isrc/utils/operations -Isrc/utils/parser -Isrc/utils/file_management -Isrc/utils/translator -Isrc/encryption_manager -c src/utils/operations/operations.c -o src/utils/operations/operations.o
+gcc -Wall -Wextra -O2 -Isrc -Isrc/bmp_handler -Isrc/common -Isrc/lsb1 -Isrc/lsb4 -Isrc/lsbi -Isrc/utils/operations -Isrc/utils/parser -Isrc/utils/file_management -Isrc/utils/payload_source -Isrc/utils/thread_pool -Isrc/utils/chunk_ring -Isrc/utils/translator -Isrc/encryption_manager -c src/utils/operations/operations.c -o src/utils/operations/operations.o
+
+echo -e "${WHITE}   batch.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -Isrc -Isrc/bmp_handler -Isrc/utils/batch -Isrc/utils/operations -Isrc/utils/parser -Isrc/utils/file_management -Isrc/utils/thread_pool -c src/utils/batch/batch.c -o src/utils/batch/batch.o
+
+echo -e "${WHITE}   server.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -Isrc -Isrc/utils/server -Isrc/utils/operations -Isrc/utils/parser -Isrc/utils/thread_pool -c src/utils/server/server.c -o src/utils/server/server.o
 
 echo -e "${WHITE}   encryption_manager.c${NC}"
 gcc -Wall -Wextra -O2 -Isrc -Isrc/encryption_manager -c src/encryption_manager/encryption_manager.c -o src/encryption_manager/encryption_manager.o
 
+echo -e "${WHITE}   libstegobmp.c${NC}"
+gcc -Wall -Wextra -O2 -pthread -Isrc -Isrc/libstegobmp -Isrc/bmp_handler -Isrc/common -Isrc/steg_stream -Isrc/utils/operations -Isrc/utils/parser -Isrc/utils/thread_pool -Isrc/utils/translator -Isrc/encryption_manager -c src/libstegobmp/libstegobmp.c -o src/libstegobmp/libstegobmp.o
+
 echo ""
 echo -e "${PURPLE} Linking everything together...${NC}"
 
@@ -73,16 +115,55 @@ echo -e "${PURPLE} Linking everything together...${NC}"
 gcc -Wall -Wextra -O2 -o stegobmp \
     src/main.o \
     src/bmp_handler/bmp_handler.o \
+    src/bmp_handler/bmp_stream.o \
+    src/bmp_handler/bmp_cache.o \
     src/common/bmp_image.o \
+    src/common/cpu_features.o \
     src/lsb1/lsb1.o \
+    src/lsb1/lsb1_simd.o \
     src/lsb4/lsb4.o \
+    src/lsb4/lsb4_simd.o \
     src/lsbi/lsbi.o \
+    src/lsbi/lsbi_simd.o \
+    src/lsbn/lsbn.o \
+    src/steg_stream/steg_stream.o \
     src/utils/file_management/file_management.o \
+    src/utils/payload_source/payload_source.o \
+    src/utils/thread_pool/thread_pool.o \
+    src/utils/chunk_ring/chunk_ring.o \
     src/utils/parser/parser.o \
     src/utils/translator/translator.o \
     src/utils/operations/operations.o \
+    src/utils/batch/batch.o \
+    src/utils/server/server.o \
     src/encryption_manager/encryption_manager.o \
-    -lssl -lcrypto
+    -lssl -lcrypto -pthread
+
+# Biblioteca estatica: todo menos main, -batch y -serve (la compartida sale de make lib, con -fPIC)
+rm -f libstegobmp.a
+ar rcs libstegobmp.a \
+    src/bmp_handler/bmp_handler.o \
+    src/bmp_handler/bmp_stream.o \
+    src/bmp_handler/bmp_cache.o \
+    src/common/bmp_image.o \
+    src/common/cpu_features.o \
+    src/lsb1/lsb1.o \
+    src/lsb1/lsb1_simd.o \
+    src/lsb4/lsb4.o \
+    src/lsb4/lsb4_simd.o \
+    src/lsbi/lsbi.o \
+    src/lsbi/lsbi_simd.o \
+    src/lsbn/lsbn.o \
+    src/steg_stream/steg_stream.o \
+    src/utils/file_management/file_management.o \
+    src/utils/payload_source/payload_source.o \
+    src/utils/thread_pool/thread_pool.o \
+    src/utils/chunk_ring/chunk_ring.o \
+    src/utils/parser/parser.o \
+    src/utils/translator/translator.o \
+    src/utils/operations/operations.o \
+    src/encryption_manager/encryption_manager.o \
+    src/libstegobmp/libstegobmp.o
 
 echo ""
 echo -e "${GREEN}╔══════════════════════════════════════════════════════════════╗${NC}"
@@ -90,8 +171,9 @@ echo -e "${GREEN}║
 echo -e "${GREEN}║   BUILD COMPLETE! Executable: ${WHITE}stegobmp${GREEN}                    ║${NC}"
 echo -e "${GREEN}║                                                              ║${NC}"
 echo -e "${GREEN}║   Ready to hide secrets in BMP files!                     ║${NC}"
-echo -e "${GREEN}║   Supports: LSB1, LSB4, LSBI steganography                ║${NC}"
+echo -e "${GREEN}║   Supports: LSB1..LSB8, LSBI steganography                ║${NC}"
 echo -e "${GREEN}║    Includes: AES encryption support                      ║${NC}"
+echo -e "${GREEN}║    Library: ${WHITE}libstegobmp.a${GREEN} (libstegobmp.so: make lib)     ║${NC}"
 echo -e "${GREEN}║                                                              ║${NC}"
 echo -e "${GREEN}╚══════════════════════════════════════════════════════════════╝${NC}"
 echo ""
@@ -103,15 +185,25 @@ echo ""
 echo -e "${WHITE}REQUIRED PARAMETERS:${NC}"
 echo -e "${YELLOW}  -embed${NC}                    Enable embedding mode"
 echo -e "${YELLOW}  -extract${NC}                  Enable extraction mode"
-echo -e "${YELLOW}  -in <file>${NC}               Input file to hide (embed mode only)"
+echo -e "${YELLOW}  -info${NC}                     Print the carrier capacity per method (only -p, reads the headers)"
+echo -e "${YELLOW}  -in <file>${NC}               Input file to hide (embed mode only), - for stdin"
 echo -e "${YELLOW}  -p <bitmapfile>${NC}          Carrier BMP file"
 echo -e "${YELLOW}  -out <bitmapfile>${NC}        Output BMP file"
-echo -e "${YELLOW}  -steg <method>${NC}           Steganography method: LSB1, LSB4, LSBI"
+echo -e "${YELLOW}  -steg <method>${NC}           Steganography method: LSB1..LSB8, LSBI, auto"
 echo ""
 echo -e "${WHITE}OPTIONAL PARAMETERS:${NC}"
 echo -e "${YELLOW}  -a <algorithm>${NC}           Encryption algorithm: aes128, aes192, aes256, 3des"
 echo -e "${YELLOW}  -m <mode>${NC}                Encryption mode: ecb, cfb, ofb, cbc"
 echo -e "${YELLOW}  -pass <password>${NC}         Encryption password"
+echo -e "${YELLOW}  -stream${NC}                  Embed reading the carrier in row bands (bounded memory)"
+echo -e "${YELLOW}  -band <size>${NC}             Band size for -stream, e.g. 512K, 8M (implies -stream)"
+echo -e "${YELLOW}  -delta${NC}                   Clone the carrier (reflink when supported) and write only the modified rows"
+echo -e "${YELLOW}  -inplace${NC}                 Write only the modified rows into the carrier itself (no -out)"
+echo -e "${YELLOW}  -threads <n>${NC}             Worker threads for embed/extract (default: online CPUs)"
+echo -e "${YELLOW}  -batch <manifest>${NC}        Run one embed/extract job per manifest line (-threads = workers)"
+echo -e "${YELLOW}  -cache <size>${NC}            Carrier cache budget for -batch/-serve, e.g. 512M (default 256M, 0 = off)"
+echo -e "${YELLOW}  -serve <socket>${NC}          Answer embed/extract requests on a Unix socket (-threads = workers)"
+echo -e "${YELLOW}  -ext <.ext>${NC}              Extension stored with the payload (default: taken from -in)"
 echo ""
 echo -e "${WHITE}USAGE EXAMPLES:${NC}"
 echo ""
@@ -119,15 +211,24 @@ echo -e "${GREEN}EMBED (Hide file in BMP):${NC}"
 echo -e "${YELLOW}  ./stegobmp -embed -in secret.txt -p carrier.bmp -out hidden.bmp -steg LSB1${NC}"
 echo -e "${YELLOW}  ./stegobmp -embed -in document.pdf -p image.bmp -out result.bmp -steg LSB4${NC}"
 echo -e "${YELLOW}  ./stegobmp -embed -in data.bin -p photo.bmp -out encrypted.bmp -steg LSBI -a aes256 -m cbc -pass mypassword${NC}"
+echo -e "${YELLOW}  ./stegobmp -embed -in notes.txt -p photo.bmp -out result.bmp -steg auto${NC}"
+echo -e "${YELLOW}  tar c docs/ | ./stegobmp -embed -in - -p photo.bmp -out result.bmp -steg LSB4${NC}"
 echo ""
 echo -e "${GREEN}EXTRACT (Recover hidden file):${NC}"
 echo -e "${YELLOW}  ./stegobmp -extract -p hidden.bmp -out recovered.txt -steg LSB1${NC}"
 echo -e "${YELLOW}  ./stegobmp -extract -p result.bmp -out document.pdf -steg LSB4${NC}"
 echo -e "${YELLOW}  ./stegobmp -extract -p encrypted.bmp -out data.bin -steg LSBI -a aes256 -m cbc -pass mypassword${NC}"
+echo -e "${YELLOW}  ./stegobmp -extract -p result.bmp -out notes.txt -steg auto${NC}"
+echo -e "${YELLOW}  ./stegobmp -info -p photo.bmp${NC}"
+echo ""
+echo -e "${GREEN}BATCH (Many jobs, one process):${NC}"
+echo -e "${YELLOW}  ./stegobmp -batch jobs.txt -threads 8 > report.tsv${NC}"
+echo -e "${YELLOW}  ./stegobmp -serve /tmp/stegobmp.sock -threads 8${NC}"
 echo ""
 echo -e "${WHITE}STEGANOGRAPHY METHODS:${NC}"
 echo -e "${CYAN}  LSB1${NC}  - Least Significant Bit (1 bit per pixel)"
 echo -e "${CYAN}  LSB4${NC}  - Least Significant Bits (4 bits per pixel)"
+echo -e "${CYAN}  LSBn${NC}  - n bits per pixel, n = 2, 3, 5, 6, 7, 8 (LSB2 ... LSB8)"
 echo -e "${CYAN}  LSBI${NC}  - LSB Enhanced (improved algorithm)"
 echo ""
 echo -e "${WHITE}ENCRYPTION ALGORITHMS:${NC}"
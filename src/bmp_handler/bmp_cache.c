@@ -0,0 +1,313 @@
+#define _GNU_SOURCE
+#include "bmp_cache.h"
+#include "../utils/file_management/file_management.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct CacheEntry {
+    dev_t dev;                      // Identidad del archivo cacheado
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    struct timespec ctime;
+    int memfd;                      // Copia sellada del archivo completo
+    BITMAPFILEHEADER fileHeader;    // Cabeceras ya validadas
+    BITMAPINFOHEADER infoHeader;
+    struct CacheEntry *prev;        // Lista LRU: head es el más reciente
+    struct CacheEntry *next;
+} CacheEntry;
+
+struct BmpCache {
+    pthread_mutex_t lock;
+    size_t budget;
+    size_t used;                    // Bytes de las entradas vivas
+    CacheEntry *head;
+    CacheEntry *tail;
+    size_t hits;
+    size_t misses;
+};
+
+static bool same_time(struct timespec a, struct timespec b) {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+static bool same_file(const CacheEntry *e, const struct stat *st) {
+    return e->dev == st->st_dev && e->ino == st->st_ino;
+}
+
+static bool same_version(const CacheEntry *e, const struct stat *st) {
+    return same_file(e, st) && e->size == st->st_size &&
+           same_time(e->mtime, st->st_mtim) && same_time(e->ctime, st->st_ctim);
+}
+
+static void unlink_entry(BmpCache *cache, CacheEntry *e) {
+    if (e->prev) e->prev->next = e->next; else cache->head = e->next;
+    if (e->next) e->next->prev = e->prev; else cache->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void push_front(BmpCache *cache, CacheEntry *e) {
+    e->prev = NULL;
+    e->next = cache->head;
+    if (cache->head) cache->head->prev = e; else cache->tail = e;
+    cache->head = e;
+}
+
+static void free_entry(CacheEntry *e) {
+    close(e->memfd);
+    free(e);
+}
+
+static void drop_entry(BmpCache *cache, CacheEntry *e) {
+    unlink_entry(cache, e);
+    cache->used -= (size_t)e->size;
+    free_entry(e);
+}
+
+static CacheEntry *find_entry(BmpCache *cache, const struct stat *st) {
+    for (CacheEntry *e = cache->head; e != NULL; e = e->next) {
+        if (same_file(e, st)) return e;
+    }
+    return NULL;
+}
+
+// Mapeo privado de la copia: cada trabajo escribe sobre sus propias páginas
+static int clone_entry(const CacheEntry *e, Bmp *out) {
+    size_t fileSize = (size_t)e->size;
+    void *base = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, e->memfd, 0);
+
+    if (base == MAP_FAILED) {
+        return -11;
+    }
+
+    out->fileHeader = e->fileHeader;
+    out->infoHeader = e->infoHeader;
+    out->mapping = (uint8_t*)base;
+    out->mappingSize = fileSize;
+    out->pixels = out->mapping + e->fileHeader.bfOffBits;
+    out->pixelsSize = fileSize - e->fileHeader.bfOffBits;
+    return 0;
+}
+
+// Lee el portador una vez a un memfd y lo sella: nadie puede modificar la copia
+static int load_entry(const char *path, CacheEntry **out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        fprintf(stderr, "[bmp] no pude abrir %s\n", path);
+        return -1;
+    }
+
+    // La clave sale del descriptor abierto, no del stat() de la búsqueda
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -8;
+    }
+
+    size_t fileSize = (size_t)st.st_size;
+    if (fileSize < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)) {
+        fprintf(stderr, "[bmp] archivo demasiado chico (%zu bytes)\n", fileSize);
+        close(fd);
+        return -2;
+    }
+
+    CacheEntry *e = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    if (!e) {
+        close(fd);
+        return -11;
+    }
+
+    e->dev = st.st_dev;
+    e->ino = st.st_ino;
+    e->size = st.st_size;
+    e->mtime = st.st_mtim;
+    e->ctime = st.st_ctim;
+    e->memfd = memfd_create("stegobmp-carrier", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    void *base = MAP_FAILED;
+    if (e->memfd >= 0 && ftruncate(e->memfd, st.st_size) == 0) {
+        base = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, e->memfd, 0);
+    }
+
+    if (base == MAP_FAILED) {
+        close(fd);
+        if (e->memfd >= 0) close(e->memfd);
+        free(e);
+        return -11;
+    }
+
+    int rc = 0;
+    if (pread_all(fd, base, fileSize, 0) != 0) {
+        fprintf(stderr, "[bmp] fread pixels\n");
+        rc = -13;
+    } else {
+        Bmp headers;
+        memset(&headers, 0, sizeof(headers));
+        memcpy(&headers.fileHeader, base, sizeof(BITMAPFILEHEADER));
+        memcpy(&headers.infoHeader, (uint8_t*)base + sizeof(BITMAPFILEHEADER), sizeof(BITMAPINFOHEADER));
+        rc = bmp_validate_headers(&headers, fileSize);
+        e->fileHeader = headers.fileHeader;
+        e->infoHeader = headers.infoHeader;
+    }
+
+    munmap(base, fileSize);
+    close(fd);
+
+    if (rc != 0) {
+        free_entry(e);
+        return rc;
+    }
+
+    // Sin mapeos compartidos abiertos se puede sellar contra escrituras
+    fcntl(e->memfd, F_ADD_SEALS, F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE);
+
+    *out = e;
+    return 0;
+}
+
+BmpCache *bmp_cache_create(size_t budget) {
+    if (budget == 0) {
+        return NULL;
+    }
+
+    BmpCache *cache = (BmpCache*)calloc(1, sizeof(BmpCache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->budget = budget;
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+int bmp_cache_read(BmpCache *cache, const char *path, Bmp *out) {
+    memset(out, 0, sizeof(*out));
+
+    // Lo que no entra en el cache (o no es un archivo regular) se lee como siempre
+    struct stat st;
+    if (cache == NULL || stat(path, &st) != 0 || !S_ISREG(st.st_mode) ||
+        st.st_size < 0 || (size_t)st.st_size > cache->budget) {
+        return bmp_read(path, out);
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry *e = find_entry(cache, &st);
+    bool hit = false;
+
+    if (e != NULL && same_version(e, &st)) {
+        hit = true;
+        cache->hits++;
+        unlink_entry(cache, e);
+        push_front(cache, e);
+    } else {
+        // Una versión vieja del mismo archivo ya no sirve
+        if (e != NULL) {
+            drop_entry(cache, e);
+        }
+        cache->misses++;
+        pthread_mutex_unlock(&cache->lock);
+
+        CacheEntry *loaded = NULL;
+        int rc = load_entry(path, &loaded);
+        if (rc != 0) {
+            return rc;
+        }
+
+        struct stat key;
+        memset(&key, 0, sizeof(key));
+        key.st_dev = loaded->dev;
+        key.st_ino = loaded->ino;
+
+        pthread_mutex_lock(&cache->lock);
+        e = find_entry(cache, &key);
+
+        // Otro hilo pudo cargar el mismo archivo mientras tanto
+        if (e != NULL && e->size == loaded->size && same_time(e->mtime, loaded->mtime) &&
+            same_time(e->ctime, loaded->ctime)) {
+            free_entry(loaded);
+            unlink_entry(cache, e);
+        } else {
+            if (e != NULL) {
+                drop_entry(cache, e);
+            }
+            e = loaded;
+            cache->used += (size_t)e->size;
+        }
+        push_front(cache, e);
+
+        // Se desalojan las menos usadas; los mapeos ya entregados siguen siendo válidos
+        while (cache->used > cache->budget && cache->tail != e) {
+            drop_entry(cache, cache->tail);
+        }
+    }
+
+    int rc = clone_entry(e, out);
+    pthread_mutex_unlock(&cache->lock);
+
+    if (rc != 0) {
+        memset(out, 0, sizeof(*out));
+        return rc;
+    }
+
+    int32_t w = out->infoHeader.biWidth, h = out->infoHeader.biHeight;
+    int rowSize = ((w * 3) + 3) & ~3;
+    fprintf(stderr, "[bmp] OK %dx%d, rowSize=%d, pixels=%zu bytes (cache%s)\n", w, h, rowSize, out->pixelsSize,
+            hit ? "" : ", cargado");
+    return 0;
+}
+
+int bmp_cache_read_headers(BmpCache *cache, const char *path, Bmp *out) {
+    memset(out, 0, sizeof(*out));
+
+    struct stat st;
+    if (cache == NULL || stat(path, &st) != 0) {
+        return bmp_read_headers(path, out);
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry *e = find_entry(cache, &st);
+    bool hit = e != NULL && same_version(e, &st);
+    if (hit) {
+        out->fileHeader = e->fileHeader;
+        out->infoHeader = e->infoHeader;
+        out->pixelsSize = (size_t)e->size - e->fileHeader.bfOffBits;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return hit ? 0 : bmp_read_headers(path, out);
+}
+
+void bmp_cache_stats(BmpCache *cache, size_t *hits, size_t *misses) {
+    *hits = 0;
+    *misses = 0;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    *hits = cache->hits;
+    *misses = cache->misses;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void bmp_cache_destroy(BmpCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    while (cache->head != NULL) {
+        drop_entry(cache, cache->head);
+    }
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
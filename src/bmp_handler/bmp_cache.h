@@ -0,0 +1,79 @@
+#ifndef BMP_CACHE_H
+#define BMP_CACHE_H
+
+#include <stddef.h>
+#include "bmp_handler.h"
+
+/**
+ * @file bmp_cache.h
+ * @brief Process-wide cache of decoded carriers for -batch and -serve
+ *
+ * Each entry holds the validated headers and a sealed, read-only memfd copy of
+ * the carrier file. A lookup hands out a private (copy-on-write) mapping of
+ * that copy, so every job gets its own writable Bmp while untouched pages stay
+ * shared, and a warm carrier costs one stat() instead of an open, a header
+ * parse and the pixel reads.
+ *
+ * Entries are keyed by the file identity (device, inode, size, mtime, ctime):
+ * the same file reached through another path or a /proc/self/fd link hits the
+ * same entry, and any change to the file makes the old entry stale. The
+ * least recently used entries are dropped once the cached bytes exceed the
+ * budget. Mappings already handed out stay valid after their entry is dropped.
+ */
+
+/** Budget used by -batch and -serve when -cache is not given */
+#define BMP_CACHE_DEFAULT_BUDGET ((size_t)256 << 20)
+
+typedef struct BmpCache BmpCache;
+
+/**
+ * @brief Creates an empty cache
+ *
+ * @param budget Most carrier bytes kept at once; carriers larger than this are never cached
+ *
+ * @return New cache, or NULL if budget is 0 or allocation failed
+ */
+BmpCache *bmp_cache_create(size_t budget);
+
+/**
+ * @brief Reads a carrier through the cache
+ *
+ * Behaves like bmp_read(): on success out is a private copy-on-write mapping
+ * that the caller releases with bmp_free(), and changes to it never reach the
+ * cache or the file. Carriers that cannot be cached fall back to bmp_read().
+ *
+ * @param cache Cache to use (NULL reads the file directly)
+ * @param path Path to the BMP file
+ * @param out Pointer to the Bmp structure to fill in
+ *
+ * @return 0 on success, the same negative codes as bmp_read() on failure
+ *
+ * @note Thread-safe; concurrent misses on the same carrier may load it twice
+ */
+int bmp_cache_read(BmpCache *cache, const char *path, Bmp *out);
+
+/**
+ * @brief Reads only the headers of a carrier, from the cache when it holds the file
+ *
+ * Same result as bmp_read_headers(); a miss reads the headers from the file
+ * and does not load the carrier into the cache.
+ *
+ * @param cache Cache to use (NULL reads the file directly)
+ * @param path Path to the BMP file
+ * @param out Pointer to Bmp structure; only fileHeader, infoHeader and pixelsSize are set
+ *
+ * @return 0 on success, the same negative codes as bmp_read_headers() on failure
+ */
+int bmp_cache_read_headers(BmpCache *cache, const char *path, Bmp *out);
+
+/**
+ * @brief Returns how many lookups were answered from the cache and how many loaded the file
+ */
+void bmp_cache_stats(BmpCache *cache, size_t *hits, size_t *misses);
+
+/**
+ * @brief Drops every entry and frees the cache (NULL is allowed)
+ */
+void bmp_cache_destroy(BmpCache *cache);
+
+#endif // BMP_CACHE_H
@@ -1,134 +1,336 @@
 #include "bmp_handler.h"
+#include "../utils/file_management/file_management.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-int bmp_read(const char *path, Bmp *out) {
-    FILE *f = fopen(path, "rb");
-
-    if (!f) { 
-        fprintf(stderr, "[bmp] no pude abrir %s\n", path); 
-        return -1; 
-    }
-
-    if (fread(&out->fileHeader, sizeof(BITMAPFILEHEADER), 1, f) != 1) {
-        fprintf(stderr, "[bmp] fread fileHeader\n"); 
-        fclose(f); 
-        return -2;
-    }
-
+int bmp_validate_headers(const Bmp *out, size_t fileSize) {
     if (out->fileHeader.bfType != 0x4D42) { // 'BM' en LE
         fprintf(stderr, "[bmp] bfType != 'BM' (0x%04X)\n", out->fileHeader.bfType); 
-        fclose(f); 
         return -3;
     }
 
-    if (fread(&out->infoHeader, sizeof(BITMAPINFOHEADER), 1, f) != 1) {
-        fprintf(stderr, "[bmp] fread infoHeader\n"); 
-        fclose(f); 
-        return -4;
-    }
-
     if (out->infoHeader.biSize != 40) {
         fprintf(stderr, "[bmp] biSize != 40 (=%u)\n", out->infoHeader.biSize); 
-        fclose(f); 
         return -5;
     }
 
     if (out->infoHeader.biBitCount != 24) {
         fprintf(stderr, "[bmp] biBitCount != 24 (=%u)\n", out->infoHeader.biBitCount); 
-        fclose(f); 
         return -6;
     }
 
     if (out->infoHeader.biCompression != 0) {
         fprintf(stderr, "[bmp] biCompression != 0 (=%u)\n", out->infoHeader.biCompression); 
-        fclose(f); 
         return -7;
     }
 
-    // tamaño total del archivo
-    if (fseek(f, 0, SEEK_END) != 0) { 
-        fclose(f); 
-        return -8; 
+    // offset válido
+    if ((size_t)out->fileHeader.bfOffBits >= fileSize) {
+        fprintf(stderr, "[bmp] bfOffBits fuera de rango (%u >= %zu)\n", out->fileHeader.bfOffBits, fileSize);
+        return -10;
     }
 
-    long fileSize = ftell(f);
+    // Las cabeceras no pueden prometer más filas de las que tiene el archivo: los kernels se saldrían de los píxeles
+    int32_t w = out->infoHeader.biWidth, h = out->infoHeader.biHeight;
+    size_t width = (size_t)(w > 0 ? w : -w);
+    size_t height = (size_t)(h > 0 ? h : -h);
+    size_t rowSize = (width * 3 + 3) & ~(size_t)3;
+    size_t pixelsSize = fileSize - out->fileHeader.bfOffBits;
 
-    if (fileSize < 0) { 
-        fclose(f); 
-        return -9; 
+    if (height * rowSize > pixelsSize) {
+        fprintf(stderr, "[bmp] datos de pixeles incompletos (%zu < %zu bytes)\n", pixelsSize, height * rowSize);
+        return -14;
     }
 
-    // offset válido
-    if ((long)out->fileHeader.bfOffBits >= fileSize) {
-        fprintf(stderr, "[bmp] bfOffBits fuera de rango (%u >= %ld)\n", out->fileHeader.bfOffBits, fileSize);
-        fclose(f); 
-        return -10;
+    return 0;
+}
+
+// Lectura clasica a memoria, para cuando el portador no se puede mapear
+static int read_pixels(int fd, Bmp *out, size_t fileSize) {
+    if (pread_all(fd, &out->fileHeader, sizeof(BITMAPFILEHEADER), 0) != 0) {
+        fprintf(stderr, "[bmp] fread fileHeader\n"); 
+        return -2;
+    }
+
+    if (pread_all(fd, &out->infoHeader, sizeof(BITMAPINFOHEADER), sizeof(BITMAPFILEHEADER)) != 0) {
+        fprintf(stderr, "[bmp] fread infoHeader\n"); 
+        return -4;
+    }
+
+    int rc = bmp_validate_headers(out, fileSize);
+    if (rc != 0) {
+        return rc;
     }
 
-    out->pixelsSize = (size_t)(fileSize - out->fileHeader.bfOffBits);
+    out->pixelsSize = fileSize - out->fileHeader.bfOffBits;
     out->pixels = (uint8_t*)malloc(out->pixelsSize);
 
     if (!out->pixels) { 
-        fclose(f); 
         return -11; 
     }
 
-    if (fseek(f, out->fileHeader.bfOffBits, SEEK_SET) != 0) { 
-        fclose(f); free(out->pixels); 
-        return -12; 
-    }
-
-    if (fread(out->pixels, 1, out->pixelsSize, f) != out->pixelsSize) {
+    if (pread_all(fd, out->pixels, out->pixelsSize, (off_t)out->fileHeader.bfOffBits) != 0) {
         fprintf(stderr, "[bmp] fread pixels\n"); 
-        fclose(f); 
-        free(out->pixels); 
+        free(out->pixels);
+        out->pixels = NULL;
         return -13;
     }
 
-    fclose(f);
+    return 0;
+}
+
+// Mapea el portador completo como MAP_PRIVATE: las páginas se comparten con el
+// page cache hasta que un kernel LSB las modifica (copy-on-write)
+static int map_pixels(int fd, Bmp *out, size_t fileSize) {
+    void *base = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    if (base == MAP_FAILED) {
+        return 1;
+    }
+
+    memcpy(&out->fileHeader, base, sizeof(BITMAPFILEHEADER));
+    memcpy(&out->infoHeader, (uint8_t*)base + sizeof(BITMAPFILEHEADER), sizeof(BITMAPINFOHEADER));
+
+    int rc = bmp_validate_headers(out, fileSize);
+    if (rc != 0) {
+        munmap(base, fileSize);
+        return rc;
+    }
+
+    // Los kernels recorren los píxeles de forma secuencial desde el inicio
+    madvise(base, fileSize, MADV_SEQUENTIAL);
+
+    out->mapping = (uint8_t*)base;
+    out->mappingSize = fileSize;
+    out->pixels = out->mapping + out->fileHeader.bfOffBits;
+    out->pixelsSize = fileSize - out->fileHeader.bfOffBits;
+    return 0;
+}
+
+int bmp_read(const char *path, Bmp *out) {
+    memset(out, 0, sizeof(*out));
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) { 
+        fprintf(stderr, "[bmp] no pude abrir %s\n", path); 
+        return -1; 
+    }
+
+    // tamaño total del archivo
+    struct stat st;
+    if (fstat(fd, &st) != 0) { 
+        close(fd); 
+        return -8; 
+    }
+
+    if (!S_ISREG(st.st_mode) || st.st_size < 0) { 
+        close(fd); 
+        return -9; 
+    }
+
+    size_t fileSize = (size_t)st.st_size;
+
+    if (fileSize < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)) {
+        fprintf(stderr, "[bmp] archivo demasiado chico (%zu bytes)\n", fileSize);
+        close(fd);
+        return -2;
+    }
+
+    int rc = map_pixels(fd, out, fileSize);
+    if (rc > 0) {
+        rc = read_pixels(fd, out, fileSize);
+    }
+
+    close(fd);
+
+    if (rc != 0) {
+        memset(out, 0, sizeof(*out));
+        return rc;
+    }
 
     // log útil:
     int32_t w = out->infoHeader.biWidth, h = out->infoHeader.biHeight;
     int rowSize = ((w * 3) + 3) & ~3;
-    fprintf(stderr, "[bmp] OK %dx%d, rowSize=%d, pixels=%zu bytes\n", w, h, rowSize, out->pixelsSize);
+    fprintf(stderr, "[bmp] OK %dx%d, rowSize=%d, pixels=%zu bytes%s\n", w, h, rowSize, out->pixelsSize,
+            out->mapping ? " (mmap)" : "");
+    return 0;
+}
+
+int bmp_read_headers(const char *path, Bmp *out) {
+    memset(out, 0, sizeof(*out));
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) { 
+        fprintf(stderr, "[bmp] no pude abrir %s\n", path); 
+        return -1; 
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { 
+        close(fd); 
+        return -8; 
+    }
+
+    if (!S_ISREG(st.st_mode) || st.st_size < 0) { 
+        close(fd); 
+        return -9; 
+    }
+
+    size_t fileSize = (size_t)st.st_size;
+    int rc = 0;
+
+    if (pread_all(fd, &out->fileHeader, sizeof(BITMAPFILEHEADER), 0) != 0 ||
+        pread_all(fd, &out->infoHeader, sizeof(BITMAPINFOHEADER), sizeof(BITMAPFILEHEADER)) != 0) {
+        fprintf(stderr, "[bmp] archivo demasiado chico (%zu bytes)\n", fileSize);
+        rc = -2;
+    } else {
+        rc = bmp_validate_headers(out, fileSize);
+    }
+
+    close(fd);
+
+    if (rc != 0) {
+        memset(out, 0, sizeof(*out));
+        return rc;
+    }
+
+    out->pixelsSize = fileSize - out->fileHeader.bfOffBits;
     return 0;
 }
 
+int bmp_zero_gap(int fd, uint32_t bfOffBits) {
+    // Hueco entre las cabeceras y los píxeles en cero, como con un archivo nuevo
+    size_t headers_size = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+    if (bfOffBits <= headers_size) 
+        return 0;
+
+    size_t gap = bfOffBits - headers_size;
+    uint8_t *zeros = (uint8_t*)calloc(1, gap);
+
+    int rc = (zeros && pwrite_all(fd, zeros, gap, (off_t)headers_size) == 0) ? 0 : -1;
+    free(zeros);
+    return rc;
+}
+
 int bmp_write(const char *path, const Bmp *bmp) {
-    FILE *f = fopen(path, "wb");
+    // Sin O_TRUNC: si la salida es el mismo portador mapeado, truncarlo antes de
+    // escribir invalidaría las páginas que todavía no se copiaron
+    int fd = open(path, O_WRONLY | O_CREAT, 0666);
 
-    if (!f) 
+    if (fd < 0) 
         return -1;
         
-    if (fwrite(&bmp->fileHeader, sizeof(BITMAPFILEHEADER), 1, f) != 1) { 
-        fclose(f); 
+    if (pwrite_all(fd, &bmp->fileHeader, sizeof(BITMAPFILEHEADER), 0) != 0) { 
+        close(fd); 
         return -2; 
     }
 
-    if (fwrite(&bmp->infoHeader, sizeof(BITMAPINFOHEADER), 1, f) != 1) { 
-        fclose(f); 
+    if (pwrite_all(fd, &bmp->infoHeader, sizeof(BITMAPINFOHEADER), sizeof(BITMAPFILEHEADER)) != 0) { 
+        close(fd); 
         return -3; 
     }
 
-    if (fseek(f, bmp->fileHeader.bfOffBits, SEEK_SET) != 0) { 
-        fclose(f); 
+    if (bmp_zero_gap(fd, bmp->fileHeader.bfOffBits) != 0) { 
+        close(fd); 
         return -4; 
     }
 
-    if (fwrite(bmp->pixels, 1, bmp->pixelsSize, f) != bmp->pixelsSize) { 
-        fclose(f); 
+    // Con el portador mapeado, las páginas que no se tocaron salen directo del page cache
+    if (pwrite_all(fd, bmp->pixels, bmp->pixelsSize, (off_t)bmp->fileHeader.bfOffBits) != 0) { 
+        close(fd); 
+        return -5; 
+    }
+
+    if (ftruncate(fd, (off_t)(bmp->fileHeader.bfOffBits + bmp->pixelsSize)) != 0) {
+        close(fd);
+        return -5;
+    }
+
+    if (close(fd) != 0) {
+        return -5;
+    }
+
+    return 0;
+}
+
+int bmp_write_delta(const char *path, const char *carrier_path, const Bmp *bmp, size_t begin, size_t end) {
+    if (end > bmp->pixelsSize || begin > end) 
+        return -4;
+
+    int fd = clone_file(carrier_path, path);
+
+    if (fd < 0) 
+        return -1;
+
+    // El clon trae el hueco del portador; se deja igual que bmp_write()
+    if (bmp_zero_gap(fd, bmp->fileHeader.bfOffBits) != 0) { 
+        close(fd); 
+        return -5; 
+    }
+
+    if (pwrite_all(fd, bmp->pixels + begin, end - begin, (off_t)(bmp->fileHeader.bfOffBits + begin)) != 0) { 
+        close(fd); 
+        return -5; 
+    }
+
+    if (close(fd) != 0) {
+        return -5;
+    }
+
+    return 0;
+}
+
+int bmp_patch(const char *path, const Bmp *bmp, size_t begin, size_t end) {
+    if (end > bmp->pixelsSize || begin > end) 
+        return -4;
+
+    int fd = open(path, O_WRONLY);
+
+    if (fd < 0) 
+        return -1;
+
+    if (pwrite_all(fd, bmp->pixels + begin, end - begin, (off_t)(bmp->fileHeader.bfOffBits + begin)) != 0) { 
+        close(fd); 
         return -5; 
     }
 
-    fclose(f);
+    if (close(fd) != 0) {
+        return -5;
+    }
+
     return 0;
 }
 
+void bmp_prefetch(const Bmp *bmp) {
+    if (bmp == NULL || bmp->mapping == NULL) {
+        return;
+    }
+
+    // Leer un byte por página trae el archivo al page cache desde este hilo;
+    // con MAP_PRIVATE la lectura no copia la página
+    long page = sysconf(_SC_PAGESIZE);
+    size_t step = page > 0 ? (size_t)page : 4096;
+    const volatile uint8_t *p = bmp->mapping;
+    uint8_t sink = 0;
+
+    for (size_t off = 0; off < bmp->mappingSize; off += step) {
+        sink ^= p[off];
+    }
+    (void)sink;
+}
+
 void bmp_free(Bmp *bmp) {
     if (bmp) {
-        free(bmp->pixels);
+        if (bmp->mapping) {
+            munmap(bmp->mapping, bmp->mappingSize);
+        } else {
+            free(bmp->pixels);
+        }
         memset(bmp, 0, sizeof(*bmp));
     }
 }
@@ -62,29 +62,75 @@ typedef struct {
     BITMAPINFOHEADER infoHeader; /**< BMP info header */
     uint8_t *pixels;             /**< Raw pixel data buffer (BGR format with row padding) */
     size_t   pixelsSize;         /**< Size of pixel data in bytes (from bfOffBits to EOF) */
+    uint8_t *mapping;            /**< Base of the private (copy-on-write) file mapping, NULL if pixels are heap-allocated */
+    size_t   mappingSize;        /**< Length of the file mapping in bytes */
 } Bmp;
 
 /**
  * @brief Reads a BMP file from disk into memory
  * 
  * This function loads a BMP file from the specified path and parses it into
- * the Bmp structure. The function allocates memory for the pixel data.
+ * the Bmp structure. The carrier is mapped with MAP_PRIVATE, so pixels are read
+ * lazily from the page cache and only the pages modified by the LSB kernels are
+ * copied. If the file cannot be mapped, the pixel data is read into a heap buffer.
  * 
  * @param path Path to the BMP file to read
  * @param out Pointer to Bmp structure where the loaded data will be stored
  * 
  * @return 0 on success, negative error code on failure:
  *         -1: Failed to open file
- *         -2: Invalid BMP file format
- *         -3: Unsupported BMP format (only 24-bit supported)
- *         -4: Memory allocation failed
+ *         -2: File too short / failed to read file header
+ *         -3: Not a BMP file ('BM' signature missing)
+ *         -5..-7: Unsupported BMP format (only 24-bit uncompressed V3 supported)
+ *         -8, -9: Failed to stat the file or not a regular file
+ *         -10: Pixel data offset out of range
+ *         -11: Memory allocation failed
+ *         -13: Failed to read pixel data
+ *         -14: File shorter than the height * rowSize pixel bytes the headers promise
  * 
  * @note The caller is responsible for calling bmp_free() to release memory
  * @note Only 24-bit uncompressed BMP files are supported
  * @note Pixel data is stored in BGR format with row padding
+ * @note Changes made to the pixels never reach the carrier file
  */
 int bmp_read(const char *path, Bmp *out);
 
+/**
+ * @brief Reads and validates only the headers of a BMP file
+ * 
+ * Reads the 54 header bytes and checks them like bmp_read() does, without
+ * mapping or reading the pixel data.
+ * 
+ * @param path Path to the BMP file to read
+ * @param out Pointer to Bmp structure; only fileHeader, infoHeader and pixelsSize are set
+ * 
+ * @return 0 on success, the same negative codes as bmp_read() on failure
+ */
+int bmp_read_headers(const char *path, Bmp *out);
+
+/**
+ * @brief Validates the file and info headers of a BMP against its file size
+ * 
+ * Only the headers of the given structure are inspected; the pixel fields may be unset.
+ * 
+ * @param bmp Pointer to a Bmp structure with fileHeader and infoHeader filled in
+ * @param fileSize Total size of the BMP file in bytes
+ * 
+ * @return 0 if the headers describe a supported 24-bit uncompressed BMP,
+ *         the same negative codes as bmp_read() otherwise
+ */
+int bmp_validate_headers(const Bmp *bmp, size_t fileSize);
+
+/**
+ * @brief Zero-fills the bytes between the headers and bfOffBits of an output BMP
+ * 
+ * @param fd File descriptor of the output, open for writing
+ * @param bfOffBits Offset of the pixel data in the output
+ * 
+ * @return 0 on success (or when there is no gap), -1 on failure
+ */
+int bmp_zero_gap(int fd, uint32_t bfOffBits);
+
 /**
  * @brief Writes a BMP structure to a file on disk
  * 
@@ -98,18 +144,65 @@ int bmp_read(const char *path, Bmp *out);
  *         -1: Failed to create/open file for writing
  *         -2: Failed to write file header
  *         -3: Failed to write info header
- *         -4: Failed to write pixel data
+ *         -4: Failed to write the gap before the pixel data
+ *         -5: Failed to write pixel data
  * 
  * @note The function overwrites existing files
  * @note All data is written in little-endian format
+ * @note The output may be the carrier the Bmp was mapped from
  */
 int bmp_write(const char *path, const Bmp *bmp);
 
+/**
+ * @brief Writes a BMP as a clone of its carrier plus the modified pixel range
+ * 
+ * The output is created as a reflink/copy of the carrier file (see clone_file())
+ * and only the pixel bytes in [begin, end) are written from memory. Pixel bytes
+ * outside that range must be unchanged with respect to the carrier.
+ * 
+ * @param path Path of the output BMP
+ * @param carrier_path Path of the carrier the Bmp was read from
+ * @param bmp Pointer to the Bmp structure with the modified pixels
+ * @param begin First modified byte, relative to the pixel data
+ * @param end One past the last modified byte, relative to the pixel data
+ * 
+ * @return 0 on success, negative error code on failure:
+ *         -1: Failed to clone the carrier
+ *         -4: Range outside the pixel data
+ *         -5: Failed to write the gap or the pixel data
+ * 
+ * @note Bytes between the headers and bfOffBits are zeroed, as bmp_write() does
+ */
+int bmp_write_delta(const char *path, const char *carrier_path, const Bmp *bmp, size_t begin, size_t end);
+
+/**
+ * @brief Patches a pixel range of an existing BMP file in place
+ * 
+ * @param path Path of the BMP to modify (normally the carrier itself)
+ * @param bmp Pointer to the Bmp structure with the modified pixels
+ * @param begin First modified byte, relative to the pixel data
+ * @param end One past the last modified byte, relative to the pixel data
+ * 
+ * @return 0 on success, negative error code on failure (same codes as bmp_write_delta())
+ */
+int bmp_patch(const char *path, const Bmp *bmp, size_t begin, size_t end);
+
+/**
+ * @brief Faults the whole carrier mapping into memory
+ * 
+ * Reads one byte per page so the carrier I/O happens on the calling thread
+ * (e.g. while the payload is being encrypted on another one) instead of
+ * page by page inside the embedding kernels.
+ * 
+ * @param bmp Pointer to a Bmp returned by bmp_read(); heap-backed pixels are left alone
+ */
+void bmp_prefetch(const Bmp *bmp);
+
 /**
  * @brief Frees memory allocated for a BMP structure
  * 
  * This function releases all memory allocated for the Bmp structure,
- * including the pixel data buffer.
+ * including the pixel data buffer or the carrier mapping.
  * 
  * @param bmp Pointer to the Bmp structure to free
  * 
@@ -0,0 +1,104 @@
+#include "bmp_stream.h"
+#include "../utils/file_management/file_management.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+int bmp_stream_open(const char *path, BmpStream *s) {
+    memset(s, 0, sizeof(*s));
+    s->fd = open(path, O_RDONLY);
+
+    if (s->fd < 0) {
+        fprintf(stderr, "[bmp] no pude abrir %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(s->fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 0) {
+        bmp_stream_close(s);
+        return -9;
+    }
+
+    size_t fileSize = (size_t)st.st_size;
+    Bmp headers;
+    memset(&headers, 0, sizeof(headers));
+
+    if (pread_all(s->fd, &headers.fileHeader, sizeof(BITMAPFILEHEADER), 0) != 0 ||
+        pread_all(s->fd, &headers.infoHeader, sizeof(BITMAPINFOHEADER), sizeof(BITMAPFILEHEADER)) != 0) {
+        fprintf(stderr, "[bmp] fread headers\n");
+        bmp_stream_close(s);
+        return -2;
+    }
+
+    int rc = bmp_validate_headers(&headers, fileSize);
+    if (rc != 0) {
+        bmp_stream_close(s);
+        return rc;
+    }
+
+    s->fileHeader = headers.fileHeader;
+    s->infoHeader = headers.infoHeader;
+    s->pixelsSize = fileSize - headers.fileHeader.bfOffBits;
+    s->width = (size_t)(headers.infoHeader.biWidth > 0 ? headers.infoHeader.biWidth : -headers.infoHeader.biWidth);
+    s->height = (size_t)(headers.infoHeader.biHeight > 0 ? headers.infoHeader.biHeight : -headers.infoHeader.biHeight);
+    s->rowSize = (s->width * 3 + 3) & ~(size_t)3;
+
+    fprintf(stderr, "[bmp] OK %zux%zu, rowSize=%zu, pixels=%zu bytes (stream)\n", s->width, s->height, s->rowSize, s->pixelsSize);
+    return 0;
+}
+
+int bmp_stream_read_rows(const BmpStream *s, size_t first_row, size_t rows, uint8_t *buf) {
+    if (first_row + rows > s->height) {
+        return -1;
+    }
+
+    off_t off = (off_t)(s->fileHeader.bfOffBits + first_row * s->rowSize);
+    return pread_all(s->fd, buf, rows * s->rowSize, off);
+}
+
+int bmp_stream_create(const char *path, const BmpStream *s) {
+    // Sin O_TRUNC: la salida puede ser el mismo portador que se está leyendo;
+    // bmp_stream_copy_rest() fija el tamaño final
+    int fd = open(path, O_WRONLY | O_CREAT, 0666);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (pwrite_all(fd, &s->fileHeader, sizeof(BITMAPFILEHEADER), 0) != 0 ||
+        pwrite_all(fd, &s->infoHeader, sizeof(BITMAPINFOHEADER), sizeof(BITMAPFILEHEADER)) != 0 ||
+        bmp_zero_gap(fd, s->fileHeader.bfOffBits) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int bmp_stream_write_rows(int out_fd, const BmpStream *s, size_t first_row, size_t rows, const uint8_t *buf) {
+    off_t off = (off_t)(s->fileHeader.bfOffBits + first_row * s->rowSize);
+    return pwrite_all(out_fd, buf, rows * s->rowSize, off);
+}
+
+int bmp_stream_copy_rest(int out_fd, const BmpStream *s, size_t first_row) {
+    size_t pos = first_row * s->rowSize;
+
+    if (pos < s->pixelsSize &&
+        copy_file_region(s->fd, out_fd, (off_t)(s->fileHeader.bfOffBits + pos), s->pixelsSize - pos) != 0) {
+        return -1;
+    }
+
+    return ftruncate(out_fd, (off_t)(s->fileHeader.bfOffBits + s->pixelsSize)) == 0 ? 0 : -1;
+}
+
+void bmp_stream_close(BmpStream *s) {
+    if (s && s->fd >= 0) {
+        close(s->fd);
+    }
+    if (s) {
+        s->fd = -1;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef BMP_STREAM_H
+#define BMP_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bmp_handler.h"
+
+/**
+ * @file bmp_stream.h
+ * @brief Row-oriented BMP access without loading the pixel array
+ * 
+ * A BmpStream keeps the carrier open and reads or writes whole pixel rows at
+ * arbitrary positions, so callers can work on bounded row bands instead of the
+ * full image.
+ */
+
+/**
+ * @brief Open carrier with validated headers and row geometry
+ */
+typedef struct {
+    int fd;                      /**< Carrier file descriptor */
+    BITMAPFILEHEADER fileHeader; /**< BMP file header */
+    BITMAPINFOHEADER infoHeader; /**< BMP info header */
+    size_t pixelsSize;           /**< Size of pixel data in bytes (from bfOffBits to EOF) */
+    size_t width;                /**< Image width in pixels */
+    size_t height;               /**< Image height in pixels */
+    size_t rowSize;              /**< Bytes per row, including padding */
+} BmpStream;
+
+/**
+ * @brief Opens a BMP carrier and reads only its headers
+ * 
+ * @param path Path to the BMP file
+ * @param s Pointer to the BmpStream to initialize
+ * 
+ * @return 0 on success, negative error code on failure (same codes as bmp_read())
+ * 
+ * @note The caller must call bmp_stream_close() on success
+ */
+int bmp_stream_open(const char *path, BmpStream *s);
+
+/**
+ * @brief Reads consecutive pixel rows into a buffer
+ * 
+ * @param s Open stream
+ * @param first_row Index of the first row to read (in file order)
+ * @param rows Number of rows to read
+ * @param buf Destination buffer of at least rows * rowSize bytes
+ * 
+ * @return 0 on success, -1 on I/O error or if the range exceeds the image
+ */
+int bmp_stream_read_rows(const BmpStream *s, size_t first_row, size_t rows, uint8_t *buf);
+
+/**
+ * @brief Creates an output BMP with the same headers as the stream
+ * 
+ * The bytes between the headers and bfOffBits are zeroed, as bmp_write() does.
+ * The file is not truncated here, so the output may be the carrier itself;
+ * bmp_stream_copy_rest() sets the final size.
+ * 
+ * @param path Path of the output file (created or overwritten)
+ * @param s Open stream whose headers are copied
+ * 
+ * @return File descriptor of the output on success, -1 on failure
+ */
+int bmp_stream_create(const char *path, const BmpStream *s);
+
+/**
+ * @brief Writes consecutive pixel rows to an output created with bmp_stream_create()
+ * 
+ * @param out_fd Output file descriptor
+ * @param s Stream describing the geometry
+ * @param first_row Index of the first row to write
+ * @param rows Number of rows to write
+ * @param buf Source buffer of rows * rowSize bytes
+ * 
+ * @return 0 on success, -1 on I/O error
+ */
+int bmp_stream_write_rows(int out_fd, const BmpStream *s, size_t first_row, size_t rows, const uint8_t *buf);
+
+/**
+ * @brief Copies the pixel data from a row to the end of the carrier unchanged
+ * 
+ * Includes any trailing bytes after the last row and truncates the output to
+ * the carrier size, so the output matches what bmp_write() would produce.
+ * The copy uses copy_file_region() and does not go through user space.
+ * 
+ * @param out_fd Output file descriptor
+ * @param s Open stream
+ * @param first_row First row to copy
+ * 
+ * @return 0 on success, -1 on I/O error
+ */
+int bmp_stream_copy_rest(int out_fd, const BmpStream *s, size_t first_row);
+
+/**
+ * @brief Closes the carrier
+ * 
+ * @note Safe to call multiple times
+ */
+void bmp_stream_close(BmpStream *s);
+
+#endif // BMP_STREAM_H
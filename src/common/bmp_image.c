@@ -28,3 +28,44 @@ Component get_component_by_index(const BMPImage *bmp, size_t index) {
     return result;
 }
 
+void bmp_span_cursor_init(BMPSpanCursor *cursor, const BMPImage *bmp, size_t first, size_t count) {
+    size_t total_components = bmp->width * bmp->height * 3;
+
+    cursor->data = bmp->data;
+    cursor->components_per_row = bmp->width * 3;
+    cursor->row_size = (cursor->components_per_row + 3) & ~(size_t)3;
+    cursor->next = first < total_components ? first : total_components;
+    cursor->end = count < total_components - cursor->next ? cursor->next + count : total_components;
+}
+
+bool bmp_span_next(BMPSpanCursor *cursor, size_t max_len, BMPSpan *span) {
+    if (cursor->next >= cursor->end) {
+        return false;
+    }
+
+    size_t len = cursor->end - cursor->next;
+
+    if (cursor->row_size == cursor->components_per_row) {
+        // Sin padding: índice de componente == offset en el buffer
+        span->ptr = cursor->data + cursor->next;
+    } else {
+        // Una división por tramo (por fila), no por componente
+        size_t pixel_row = cursor->next / cursor->components_per_row;
+        size_t offset_in_row = cursor->next - pixel_row * cursor->components_per_row;
+
+        span->ptr = cursor->data + pixel_row * cursor->row_size + offset_in_row;
+
+        if (len > cursor->components_per_row - offset_in_row) {
+            len = cursor->components_per_row - offset_in_row;
+        }
+    }
+
+    if (len > max_len) {
+        len = max_len;
+    }
+
+    span->len = len;
+    span->component = cursor->next;
+    cursor->next += len;
+    return true;
+}
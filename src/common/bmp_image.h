@@ -1,6 +1,7 @@
 #ifndef BMP_IMAGE_H
 #define BMP_IMAGE_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -38,5 +39,48 @@ typedef struct {
  */
 Component get_component_by_index(const BMPImage *bmp, size_t index);
 
+/**
+ * @brief Tramo de componentes consecutivos, contiguos en memoria.
+ */
+typedef struct {
+    uint8_t *ptr;       // Primer componente del tramo
+    size_t len;         // Cantidad de componentes
+    size_t component;   // Índice global de ptr[0] (su color es component % 3)
+} BMPSpan;
+
+/**
+ * @brief Cursor que recorre un rango de componentes como tramos contiguos.
+ *
+ * El padding de las filas nunca forma parte de un tramo. Si width * 3 es
+ * múltiplo de 4 las filas no tienen padding y todo el rango es un solo tramo.
+ */
+typedef struct {
+    uint8_t *data;              // Datos de píxeles
+    size_t components_per_row;  // width * 3
+    size_t row_size;            // Bytes por fila, con padding
+    size_t next;                // Próximo componente a entregar
+    size_t end;                 // Uno después del último componente del rango
+} BMPSpanCursor;
+
+/**
+ * @brief Inicializa un cursor sobre los componentes [first, first + count) de una imagen.
+ *
+ * @param cursor Cursor a inicializar.
+ * @param bmp    Imagen a recorrer.
+ * @param first  Índice global del primer componente.
+ * @param count  Cantidad de componentes; se recorta al final de la imagen.
+ */
+void bmp_span_cursor_init(BMPSpanCursor *cursor, const BMPImage *bmp, size_t first, size_t count);
+
+/**
+ * @brief Entrega el próximo tramo del rango, de a lo sumo max_len componentes.
+ *
+ * @param cursor  Cursor inicializado con bmp_span_cursor_init().
+ * @param max_len Largo máximo del tramo (SIZE_MAX para no limitarlo).
+ * @param span    Recibe el tramo.
+ * @return true si se entregó un tramo, false si el rango terminó.
+ */
+bool bmp_span_next(BMPSpanCursor *cursor, size_t max_len, BMPSpan *span);
+
 #endif // BMP_IMAGE_H
 
@@ -0,0 +1,44 @@
+#include "cpu_features.h"
+#include <stdlib.h>
+#include <string.h>
+
+static cpu_simd_level_t detect_level(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) 
+        return CPU_SIMD_AVX2;
+
+    if (__builtin_cpu_supports("ssse3")) 
+        return CPU_SIMD_SSSE3;
+
+    if (__builtin_cpu_supports("sse2")) 
+        return CPU_SIMD_SSE2;
+#endif
+    return CPU_SIMD_NONE;
+}
+
+cpu_simd_level_t cpu_simd_level(void) {
+    cpu_simd_level_t level = detect_level();
+    const char *cap = getenv(CPU_SIMD_ENV);
+
+    if (cap == NULL) 
+        return level;
+
+    for (cpu_simd_level_t l = CPU_SIMD_NONE; l <= CPU_SIMD_AVX2; l++) {
+        if (strcmp(cap, cpu_simd_level_to_string(l)) == 0) {
+            return l < level ? l : level;
+        }
+    }
+
+    return level;
+}
+
+const char *cpu_simd_level_to_string(cpu_simd_level_t level) {
+    switch (level) {
+        case CPU_SIMD_SSE2: return "sse2";
+        case CPU_SIMD_SSSE3: return "ssse3";
+        case CPU_SIMD_AVX2: return "avx2";
+        default: return "none";
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * @brief SIMD levels the kernels can dispatch to, in increasing order
+ */
+typedef enum {
+    CPU_SIMD_NONE = 0,  /**< Portable scalar code only */
+    CPU_SIMD_SSE2,      /**< x86 SSE2 */
+    CPU_SIMD_SSSE3,     /**< x86 SSSE3 (pshufb) */
+    CPU_SIMD_AVX2       /**< x86 AVX2 (256-bit integer) */
+} cpu_simd_level_t;
+
+/** Environment variable that caps the SIMD level: none, sse2, ssse3 or avx2 */
+#define CPU_SIMD_ENV "STEGOBMP_SIMD"
+
+/**
+ * @brief Highest SIMD level supported by the running CPU
+ * 
+ * Detected with cpuid and capped by the STEGOBMP_SIMD environment variable, so
+ * the scalar fallbacks can be forced for comparison.
+ * 
+ * @return The SIMD level kernels should use
+ * 
+ * @note Always CPU_SIMD_NONE on non-x86 builds
+ */
+cpu_simd_level_t cpu_simd_level(void);
+
+/**
+ * @brief Name of a SIMD level, as accepted by STEGOBMP_SIMD
+ */
+const char *cpu_simd_level_to_string(cpu_simd_level_t level);
+
+#endif // CPU_FEATURES_H
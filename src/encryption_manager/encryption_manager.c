@@ -100,24 +100,30 @@ static int derive_key_iv(const char *password, const EVP_CIPHER *cipher,unsigned
     return 0;
 }
 
-int encrypt_data(const stegobmp_config_t *config,
-                 const uint8_t *plaintext, size_t plaintext_len,
-                 uint8_t **ciphertext, size_t *ciphertext_len)
+// Mayor porción que se pasa de una vez a EVP_EncryptUpdate (recibe la longitud como int)
+#define ENCRYPT_UPDATE_MAX (1 << 30)
+
+struct EncryptStream {
+    EVP_CIPHER_CTX *ctx;
+    size_t block_size;
+};
+
+EncryptStream *encrypt_stream_new(const stegobmp_config_t *config)
 {
-    if (!config || !plaintext || !ciphertext || !ciphertext_len) {
+    if (!config) {
         fprintf(stderr, "Error: parametros invalidos para encriptacion\n");
-        return -1;
+        return NULL;
     }
     
     if (!is_encryption_enabled(config)) {
         fprintf(stderr, "Error: encriptacion no habilitada en config\n");
-        return -1;
+        return NULL;
     }
     
     const EVP_CIPHER *cipher = get_cipher(config->encryption_algo, config->encryption_mode);
     if (!cipher) {
         fprintf(stderr, "Error: combinacion de algoritmo/modo no soportada\n");
-        return -1;
+        return NULL;
     }
     
     unsigned char key[EVP_MAX_KEY_LENGTH];
@@ -127,82 +133,223 @@ int encrypt_data(const stegobmp_config_t *config,
     
     if (derive_key_iv(config->password, cipher, key, iv) != 0) {
         fprintf(stderr, "Error: no se pudo derivar clave e IV\n");
-        return -1;
+        return NULL;
     }
     
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) {
+    EncryptStream *stream = (EncryptStream *)calloc(1, sizeof(EncryptStream));
+    if (stream) {
+        stream->ctx = EVP_CIPHER_CTX_new();
+    }
+    if (!stream || !stream->ctx) {
         fprintf(stderr, "Error: no se pudo crear contexto de encriptacion\n");
-        return -1;
+        free(stream);
+        memset(key, 0, sizeof(key));
+        memset(iv, 0, sizeof(iv));
+        return NULL;
     }
     
-    if (EVP_EncryptInit_ex(ctx, cipher, NULL, key, iv) != 1) {
+    if (EVP_EncryptInit_ex(stream->ctx, cipher, NULL, key, iv) != 1) {
         fprintf(stderr, "Error: fallo inicializacion de encriptacion\n");
         ERR_print_errors_fp(stderr);
-        EVP_CIPHER_CTX_free(ctx);
+        encrypt_stream_free(stream);
+        stream = NULL;
+    } else {
+        stream->block_size = (size_t)EVP_CIPHER_block_size(cipher);
+    }
+    
+    // Clear sensitive data
+    memset(key, 0, sizeof(key));
+    memset(iv, 0, sizeof(iv));
+    
+    return stream;
+}
+
+int encrypt_stream_update(EncryptStream *stream, const uint8_t *in, size_t len, uint8_t *out, size_t *out_len)
+{
+    if (!stream || (!in && len > 0) || !out || !out_len) {
+        return -1;
+    }
+    
+    *out_len = 0;
+    
+    while (len > 0) {
+        int chunk = len > ENCRYPT_UPDATE_MAX ? ENCRYPT_UPDATE_MAX : (int)len;
+        int written = 0;
+        
+        if (EVP_EncryptUpdate(stream->ctx, out + *out_len, &written, in, chunk) != 1) {
+            fprintf(stderr, "Error: fallo durante encriptacion\n");
+            ERR_print_errors_fp(stderr);
+            return -1;
+        }
+        *out_len += (size_t)written;
+        in += chunk;
+        len -= (size_t)chunk;
+    }
+    
+    return 0;
+}
+
+int encrypt_stream_final(EncryptStream *stream, uint8_t *out, size_t *out_len)
+{
+    if (!stream || !out || !out_len) {
+        return -1;
+    }
+    
+    int written = 0;
+    if (EVP_EncryptFinal_ex(stream->ctx, out, &written) != 1) {
+        fprintf(stderr, "Error: fallo finalizacion de encriptacion\n");
+        ERR_print_errors_fp(stderr);
+        return -1;
+    }
+    
+    *out_len = (size_t)written;
+    return 0;
+}
+
+EncryptStream *encrypt_stream_dup(const EncryptStream *stream)
+{
+    if (!stream) {
+        return NULL;
+    }
+    
+    EncryptStream *copy = (EncryptStream *)calloc(1, sizeof(EncryptStream));
+    if (copy) {
+        copy->ctx = EVP_CIPHER_CTX_new();
+    }
+    if (!copy || !copy->ctx || EVP_CIPHER_CTX_copy(copy->ctx, stream->ctx) != 1) {
+        fprintf(stderr, "Error: no se pudo crear contexto de encriptacion\n");
+        encrypt_stream_free(copy);
+        return NULL;
+    }
+    
+    copy->block_size = stream->block_size;
+    return copy;
+}
+
+size_t encrypt_stream_block_size(const EncryptStream *stream)
+{
+    return stream ? stream->block_size : 0;
+}
+
+void encrypt_stream_free(EncryptStream *stream)
+{
+    if (!stream) {
+        return;
+    }
+    
+    // EVP_CIPHER_CTX_free también borra la clave expandida
+    EVP_CIPHER_CTX_free(stream->ctx);
+    free(stream);
+}
+
+size_t encrypted_length(const stegobmp_config_t *config, size_t plaintext_len)
+{
+    if (!config) {
+        return 0;
+    }
+    
+    const EVP_CIPHER *cipher = get_cipher(config->encryption_algo, config->encryption_mode);
+    if (!cipher) {
+        return 0;
+    }
+    
+    size_t block_size = (size_t)EVP_CIPHER_block_size(cipher);
+    if (block_size <= 1) {
+        return plaintext_len;
+    }
+    return (plaintext_len / block_size + 1) * block_size;
+}
+
+int encrypt_data(const stegobmp_config_t *config,
+                 const uint8_t *plaintext, size_t plaintext_len,
+                 uint8_t **ciphertext, size_t *ciphertext_len)
+{
+    if (!plaintext) {
+        fprintf(stderr, "Error: parametros invalidos para encriptacion\n");
+        return -1;
+    }
+
+    struct iovec iov = { (void *)plaintext, plaintext_len };
+    return encrypt_iov(config, &iov, 1, ciphertext, ciphertext_len);
+}
+
+int encrypt_iov(const stegobmp_config_t *config,
+                const struct iovec *iov, size_t iov_count,
+                uint8_t **ciphertext, size_t *ciphertext_len)
+{
+    if (!config || (!iov && iov_count > 0) || !ciphertext || !ciphertext_len) {
+        fprintf(stderr, "Error: parametros invalidos para encriptacion\n");
+        return -1;
+    }
+    
+    EncryptStream *stream = encrypt_stream_new(config);
+    if (!stream) {
         return -1;
     }
     
-    int block_size = EVP_CIPHER_block_size(cipher);
-    size_t max_ciphertext_len = plaintext_len + block_size;
+    size_t plaintext_len = 0;
+    for (size_t i = 0; i < iov_count; i++) {
+        plaintext_len += iov[i].iov_len;
+    }
+    
+    size_t max_ciphertext_len = plaintext_len + encrypt_stream_block_size(stream);
     *ciphertext = (uint8_t *)malloc(max_ciphertext_len);
     if (!*ciphertext) {
         fprintf(stderr, "Error: no se pudo asignar memoria para texto cifrado\n");
-        EVP_CIPHER_CTX_free(ctx);
+        encrypt_stream_free(stream);
         return -1;
     }
     
-    int len = 0;
-    int total_len = 0;
+    size_t total_len = 0;
+    size_t len = 0;
+    int rc = 0;
     
-    if (EVP_EncryptUpdate(ctx, *ciphertext, &len, plaintext, plaintext_len) != 1) {
-        fprintf(stderr, "Error: fallo durante encriptacion\n");
-        ERR_print_errors_fp(stderr);
-        free(*ciphertext);
-        *ciphertext = NULL;
-        EVP_CIPHER_CTX_free(ctx);
-        return -1;
+    // Cada porción se cifra donde está; el contexto arrastra el bloque parcial entre llamadas
+    for (size_t i = 0; i < iov_count && rc == 0; i++) {
+        rc = encrypt_stream_update(stream, (const uint8_t *)iov[i].iov_base, iov[i].iov_len,
+                                   *ciphertext + total_len, &len);
+        total_len += len;
     }
-    total_len = len;
     
-    if (EVP_EncryptFinal_ex(ctx, *ciphertext + len, &len) != 1) {
-        fprintf(stderr, "Error: fallo finalizacion de encriptacion\n");
-        ERR_print_errors_fp(stderr);
+    if (rc == 0) {
+        rc = encrypt_stream_final(stream, *ciphertext + total_len, &len);
+        total_len += len;
+    }
+    
+    encrypt_stream_free(stream);
+    
+    if (rc != 0) {
         free(*ciphertext);
         *ciphertext = NULL;
-        EVP_CIPHER_CTX_free(ctx);
         return -1;
     }
-    total_len += len;
     
     *ciphertext_len = total_len;
-    
-    // Cleanup
-    EVP_CIPHER_CTX_free(ctx);
-    
-    // Clear sensitive data
-    memset(key, 0, sizeof(key));
-    memset(iv, 0, sizeof(iv));
-    
     return 0;
 }
 
-int decrypt_data(const stegobmp_config_t *config,const uint8_t *ciphertext, size_t ciphertext_len,uint8_t **plaintext, size_t *plaintext_len)
+struct DecryptStream {
+    EVP_CIPHER_CTX *ctx;
+    size_t block_size;
+    bool stream_mode;
+};
+
+DecryptStream *decrypt_stream_new(const stegobmp_config_t *config)
 {
-    if (!config || !ciphertext || !plaintext || !plaintext_len) {
+    if (!config) {
         fprintf(stderr, "Error: parametros invalidos para desencriptacion\n");
-        return -1;
+        return NULL;
     }
     
     if (!is_encryption_enabled(config)) {
         fprintf(stderr, "Error: encriptacion no habilitada en config\n");
-        return -1;
+        return NULL;
     }
     
     const EVP_CIPHER *cipher = get_cipher(config->encryption_algo, config->encryption_mode);
     if (!cipher) {
         fprintf(stderr, "Error: combinacion de algoritmo/modo no soportada\n");
-        return -1;
+        return NULL;
     }
     
     unsigned char key[EVP_MAX_KEY_LENGTH];
@@ -212,76 +359,163 @@ int decrypt_data(const stegobmp_config_t *config,const uint8_t *ciphertext, size
     
     if (derive_key_iv(config->password, cipher, key, iv) != 0) {
         fprintf(stderr, "Error: no se pudo derivar clave e IV\n");
-        return -1;
+        return NULL;
     }
     
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) {
+    DecryptStream *stream = (DecryptStream *)calloc(1, sizeof(DecryptStream));
+    if (stream) {
+        stream->ctx = EVP_CIPHER_CTX_new();
+    }
+    if (!stream || !stream->ctx) {
         fprintf(stderr, "Error: no se pudo crear contexto de desencriptacion\n");
-        return -1;
+        free(stream);
+        memset(key, 0, sizeof(key));
+        memset(iv, 0, sizeof(iv));
+        return NULL;
     }
     
-    if (EVP_DecryptInit_ex(ctx, cipher, NULL, key, iv) != 1) {
+    if (EVP_DecryptInit_ex(stream->ctx, cipher, NULL, key, iv) != 1) {
         fprintf(stderr, "Error: fallo inicializacion de desencriptacion\n");
         ERR_print_errors_fp(stderr);
-        EVP_CIPHER_CTX_free(ctx);
-        return -1;
+        decrypt_stream_free(stream);
+        stream = NULL;
+    } else {
+        // Deshabilitar padding (matches working project)
+        EVP_CIPHER_CTX_set_padding(stream->ctx, 0);
+        stream->block_size = (size_t)EVP_CIPHER_block_size(cipher);
+        stream->stream_mode = (config->encryption_mode == MODE_OFB || 
+                               config->encryption_mode == MODE_CFB);
     }
     
-    // Deshabilitar padding (matches working project)
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    // Clear sensitive data
+    memset(key, 0, sizeof(key));
+    memset(iv, 0, sizeof(iv));
     
-    *plaintext = (uint8_t *)malloc(ciphertext_len);
-    if (!*plaintext) {
-        fprintf(stderr, "Error: no se pudo asignar memoria para texto plano\n");
-        EVP_CIPHER_CTX_free(ctx);
+    return stream;
+}
+
+int decrypt_stream_update(DecryptStream *stream, const uint8_t *in, size_t len, uint8_t *out, size_t *out_len)
+{
+    if (!stream || (!in && len > 0) || !out || !out_len) {
         return -1;
     }
     
-    int len = 0;
-    int total_len = 0;
+    *out_len = 0;
     
-    if (EVP_DecryptUpdate(ctx, *plaintext, &len, ciphertext, ciphertext_len) != 1) {
-        fprintf(stderr, "Error: fallo durante desencriptacion\n");
-        ERR_print_errors_fp(stderr);
-        free(*plaintext);
-        *plaintext = NULL;
-        EVP_CIPHER_CTX_free(ctx);
-        return -1;
+    while (len > 0) {
+        int chunk = len > ENCRYPT_UPDATE_MAX ? ENCRYPT_UPDATE_MAX : (int)len;
+        int written = 0;
+        
+        if (EVP_DecryptUpdate(stream->ctx, out + *out_len, &written, in, chunk) != 1) {
+            fprintf(stderr, "Error: fallo durante desencriptacion\n");
+            ERR_print_errors_fp(stderr);
+            return -1;
+        }
+        *out_len += (size_t)written;
+        in += chunk;
+        len -= (size_t)chunk;
     }
-    total_len = len;
     
-    // For stream ciphers (OFB, CFB) with padding disabled, DecryptFinal may not add bytes
-    // Check if this is a stream cipher mode
-    int is_stream_mode = (config->encryption_mode == MODE_OFB || 
-                          config->encryption_mode == MODE_CFB);
+    return 0;
+}
+
+int decrypt_stream_final(DecryptStream *stream, uint8_t *out, size_t *out_len)
+{
+    if (!stream || !out || !out_len) {
+        return -1;
+    }
     
-    if (EVP_DecryptFinal_ex(ctx, *plaintext + len, &len) != 1) {
+    int written = 0;
+    if (EVP_DecryptFinal_ex(stream->ctx, out, &written) != 1) {
         // For stream modes with padding disabled, this is expected to fail
         // The data was already decrypted in Update
-        if (!is_stream_mode) {
+        if (!stream->stream_mode) {
             fprintf(stderr, "Error: fallo finalizacion de desencriptacion\n");
             fprintf(stderr, "       (password incorrecta o datos corruptos)\n");
             ERR_print_errors_fp(stderr);
-            free(*plaintext);
-            *plaintext = NULL;
-            EVP_CIPHER_CTX_free(ctx);
             return -1;
         }
-        // For stream modes, ignore the error - data was already decrypted
-        len = 0;
+        written = 0;
     }
-    total_len += len;
     
-    *plaintext_len = total_len;
+    *out_len = (size_t)written;
+    return 0;
+}
+
+DecryptStream *decrypt_stream_dup(const DecryptStream *stream)
+{
+    if (!stream) {
+        return NULL;
+    }
     
-    // Cleanup
-    EVP_CIPHER_CTX_free(ctx);
+    DecryptStream *copy = (DecryptStream *)calloc(1, sizeof(DecryptStream));
+    if (copy) {
+        copy->ctx = EVP_CIPHER_CTX_new();
+    }
+    if (!copy || !copy->ctx || EVP_CIPHER_CTX_copy(copy->ctx, stream->ctx) != 1) {
+        fprintf(stderr, "Error: no se pudo crear contexto de desencriptacion\n");
+        decrypt_stream_free(copy);
+        return NULL;
+    }
     
-    // Clear sensitive data
-    memset(key, 0, sizeof(key));
-    memset(iv, 0, sizeof(iv));
+    copy->block_size = stream->block_size;
+    copy->stream_mode = stream->stream_mode;
+    return copy;
+}
+
+size_t decrypt_stream_block_size(const DecryptStream *stream)
+{
+    return stream ? stream->block_size : 0;
+}
+
+void decrypt_stream_free(DecryptStream *stream)
+{
+    if (!stream) {
+        return;
+    }
     
+    EVP_CIPHER_CTX_free(stream->ctx);
+    free(stream);
+}
+
+int decrypt_data(const stegobmp_config_t *config,const uint8_t *ciphertext, size_t ciphertext_len,uint8_t **plaintext, size_t *plaintext_len)
+{
+    if (!config || !ciphertext || !plaintext || !plaintext_len) {
+        fprintf(stderr, "Error: parametros invalidos para desencriptacion\n");
+        return -1;
+    }
+    
+    DecryptStream *stream = decrypt_stream_new(config);
+    if (!stream) {
+        return -1;
+    }
+    
+    // Sin padding el texto plano nunca es más largo que el cifrado
+    *plaintext = (uint8_t *)malloc(ciphertext_len + decrypt_stream_block_size(stream));
+    if (!*plaintext) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para texto plano\n");
+        decrypt_stream_free(stream);
+        return -1;
+    }
+    
+    size_t total_len = 0;
+    size_t len = 0;
+    int rc = decrypt_stream_update(stream, ciphertext, ciphertext_len, *plaintext, &total_len);
+    
+    if (rc == 0) {
+        rc = decrypt_stream_final(stream, *plaintext + total_len, &len);
+        total_len += len;
+    }
+    
+    decrypt_stream_free(stream);
+    
+    if (rc != 0) {
+        free(*plaintext);
+        *plaintext = NULL;
+        return -1;
+    }
+    
+    *plaintext_len = total_len;
     return 0;
 }
 
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 /**
  * @brief Encrypts data using the specified configuration
@@ -14,6 +15,68 @@ int encrypt_data(const stegobmp_config_t *config,
                  const uint8_t *plaintext, size_t plaintext_len,
                  uint8_t **ciphertext, size_t *ciphertext_len); 
 
+/**
+ * @brief Encrypts the concatenation of several plaintext pieces
+ * 
+ * Same result as encrypt_data() over the pieces joined in order, without
+ * assembling them: each piece is fed to the cipher where it lives.
+ * @return 0 on success, -1 on error
+ */
+int encrypt_iov(const stegobmp_config_t *config,
+                const struct iovec *iov, size_t iov_count,
+                uint8_t **ciphertext, size_t *ciphertext_len);
+
+/**
+ * @brief Incremental encryptor: key derivation once, then ciphertext in chunks
+ */
+typedef struct EncryptStream EncryptStream;
+
+/**
+ * @brief Derives the key and IV and prepares the cipher
+ * @return The new encryptor, or NULL on error
+ */
+EncryptStream *encrypt_stream_new(const stegobmp_config_t *config);
+
+/**
+ * @brief Encrypts the next plaintext chunk
+ * @param out Receives the ciphertext; needs room for len + encrypt_stream_block_size() bytes
+ * @param out_len Receives the ciphertext bytes written (may lag behind len in block modes)
+ * @return 0 on success, -1 on error
+ */
+int encrypt_stream_update(EncryptStream *stream, const uint8_t *in, size_t len, uint8_t *out, size_t *out_len);
+
+/**
+ * @brief Writes the last (padded) block
+ * @param out Needs room for encrypt_stream_block_size() bytes
+ * @return 0 on success, -1 on error
+ */
+int encrypt_stream_final(EncryptStream *stream, uint8_t *out, size_t *out_len);
+
+/**
+ * @brief Copies an encryptor in its current state, without deriving the key again
+ * @return The copy (freed with encrypt_stream_free()), or NULL on error
+ */
+EncryptStream *encrypt_stream_dup(const EncryptStream *stream);
+
+/**
+ * @brief Cipher block size (1 for the stream modes)
+ */
+size_t encrypt_stream_block_size(const EncryptStream *stream);
+
+/**
+ * @brief Frees the encryptor and wipes the key material
+ */
+void encrypt_stream_free(EncryptStream *stream);
+
+/**
+ * @brief Ciphertext length for a plaintext length, known before encrypting
+ * 
+ * Block modes add PKCS#7 padding up to the next whole block (a full block
+ * when already aligned); CFB and OFB keep the plaintext length.
+ * @return Ciphertext length, 0 if the algorithm/mode is not supported
+ */
+size_t encrypted_length(const stegobmp_config_t *config, size_t plaintext_len);
+
 /**
  * @brief Decrypts data using the specified configuration
  * @return 0 on success, -1 on error
@@ -22,6 +85,51 @@ int decrypt_data(const stegobmp_config_t *config,
                  const uint8_t *ciphertext, size_t ciphertext_len,
                  uint8_t **plaintext, size_t *plaintext_len); 
 
+/**
+ * @brief Incremental decryptor: key derivation once, then plaintext in chunks
+ * 
+ * Padding is disabled, as in decrypt_data(): the plaintext has the same length
+ * as the ciphertext and the caller finds the payload inside it.
+ */
+typedef struct DecryptStream DecryptStream;
+
+/**
+ * @brief Derives the key and IV and prepares the cipher
+ * @return The new decryptor, or NULL on error
+ */
+DecryptStream *decrypt_stream_new(const stegobmp_config_t *config);
+
+/**
+ * @brief Decrypts the next ciphertext chunk
+ * @param out Receives the plaintext; needs room for len + decrypt_stream_block_size() bytes
+ * @param out_len Receives the plaintext bytes written (may lag behind len in block modes)
+ * @return 0 on success, -1 on error
+ */
+int decrypt_stream_update(DecryptStream *stream, const uint8_t *in, size_t len, uint8_t *out, size_t *out_len);
+
+/**
+ * @brief Finishes decryption (fails in block modes if the ciphertext was not whole blocks)
+ * @param out Needs room for decrypt_stream_block_size() bytes
+ * @return 0 on success, -1 on error
+ */
+int decrypt_stream_final(DecryptStream *stream, uint8_t *out, size_t *out_len);
+
+/**
+ * @brief Copies a decryptor in its current state, without deriving the key again
+ * @return The copy (freed with decrypt_stream_free()), or NULL on error
+ */
+DecryptStream *decrypt_stream_dup(const DecryptStream *stream);
+
+/**
+ * @brief Cipher block size (1 for the stream modes)
+ */
+size_t decrypt_stream_block_size(const DecryptStream *stream);
+
+/**
+ * @brief Frees the decryptor and wipes the key material
+ */
+void decrypt_stream_free(DecryptStream *stream);
+
 /**
  * @brief Checks if encryption is enabled in the configuration
  */
@@ -0,0 +1,442 @@
+#include "libstegobmp.h"
+#include "../bmp_handler/bmp_handler.h"
+#include "../common/bmp_image.h"
+#include "../encryption_manager/encryption_manager.h"
+#include "../steg_stream/steg_stream.h"
+#include "../utils/parser/parser.h"
+#include "../utils/thread_pool/thread_pool.h"
+#include "../utils/translator/translator.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes de cifrado que se ocultan por escritura con LSBn
+#define LIB_CIPHER_CHUNK (1u << 20)
+
+// Bytes de cifrado que se extraen y descifran por vuelta
+#define LIB_DECRYPT_CHUNK (256u << 10)
+
+// Bytes después de los datos donde se busca la extension con su '\0'
+#define LIB_TAIL_MAX (STEGOBMP_EXTENSION_MAX + 1)
+
+struct StegobmpContext {
+    stegobmp_config_t config;   // Método y cifrado, como los usa encryption_manager
+    ThreadPool *pool;
+    EncryptStream *encrypt;     // Clave ya derivada: cada llamada cifra/descifra con una copia
+    DecryptStream *decrypt;
+    pthread_mutex_t lock;       // Una llamada a la vez sobre el pool
+};
+
+StegobmpContext *stegobmp_context_create(const StegobmpOptions *options)
+{
+    if (options == NULL || (steg_method_lsb_bits(options->method) == 0 && options->method != STEG_LSBI)) {
+        return NULL;
+    }
+
+    // Cifrado: algoritmo, modo y password van juntos
+    bool encrypted = options->encryption_algo != ENC_NONE;
+    if ((options->encryption_mode != MODE_NONE) != encrypted || (options->password != NULL) != encrypted) {
+        return NULL;
+    }
+
+    StegobmpContext *ctx = (StegobmpContext *)calloc(1, sizeof(StegobmpContext));
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&ctx->lock, NULL);
+    ctx->config.steg_method = options->method;
+    ctx->config.encryption_algo = options->encryption_algo;
+    ctx->config.encryption_mode = options->encryption_mode;
+    ctx->config.threads = options->threads;
+    ctx->pool = thread_pool_create(options->threads);
+
+    bool ok = true;
+    if (encrypted) {
+        ctx->config.password = strdup(options->password);
+        ok = ctx->config.password != NULL &&
+             (ctx->encrypt = encrypt_stream_new(&ctx->config)) != NULL &&
+             (ctx->decrypt = decrypt_stream_new(&ctx->config)) != NULL;
+    }
+
+    if (!ok) {
+        stegobmp_context_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+void stegobmp_context_destroy(StegobmpContext *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    encrypt_stream_free(ctx->encrypt);
+    decrypt_stream_free(ctx->decrypt);
+    thread_pool_destroy(ctx->pool);
+
+    if (ctx->config.password != NULL) {
+        memset(ctx->config.password, 0, strlen(ctx->config.password));
+    }
+    free_config(&ctx->config);
+
+    pthread_mutex_destroy(&ctx->lock);
+    free(ctx);
+}
+
+// Valida las cabeceras (también que las filas entren en el buffer) y arma la vista de los píxeles, sin copiarlos
+static OperationsResult view_carrier(const uint8_t *bmp, size_t bmp_size, BMPImage *image)
+{
+    Bmp headers;
+    memset(&headers, 0, sizeof(headers));
+
+    if (bmp_size < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)) {
+        return OPS_CARRIER_READ_FAILED;
+    }
+
+    memcpy(&headers.fileHeader, bmp, sizeof(BITMAPFILEHEADER));
+    memcpy(&headers.infoHeader, bmp + sizeof(BITMAPFILEHEADER), sizeof(BITMAPINFOHEADER));
+    if (bmp_validate_headers(&headers, bmp_size) != 0) {
+        return OPS_CARRIER_READ_FAILED;
+    }
+
+    int32_t width = headers.infoHeader.biWidth;
+    int32_t height = headers.infoHeader.biHeight;
+
+    memset(image, 0, sizeof(*image));
+    memcpy(image->header, bmp, BMP_HEADER_SIZE);
+    image->data = (uint8_t *)bmp + headers.fileHeader.bfOffBits;
+    image->data_size = bmp_size - headers.fileHeader.bfOffBits;
+    image->width = (size_t)(width > 0 ? width : -width);
+    image->height = (size_t)(height > 0 ? height : -height);
+    return OPS_OK;
+}
+
+// Oculta un tramo del cifrado; el primero va junto con la cabecera de largo
+static OperationsResult write_cipher(StegWriter *writer, const uint8_t *length_header, bool *header_done,
+                                     const uint8_t *cipher, size_t length)
+{
+    StegSegment segments[2] = { { length_header, 4 }, { cipher, length } };
+    size_t first = *header_done ? 1 : 0;
+
+    *header_done = true;
+    return steg_writer_write(writer, segments + first, 2 - first) == 0 ? OPS_OK : OPS_EMBED_FAILED;
+}
+
+/*
+ * Oculta [largo del cifrado][cifrado de tamaño + datos + extension]. Con LSBn
+ * el cifrado se oculta por tramos a medida que se produce; LSBI arma el
+ * pattern map sobre todo el bloque, así que lo recibe entero en una escritura.
+ */
+static OperationsResult embed_encrypted(StegobmpContext *ctx, StegWriter *writer, const StegSegment *plain,
+                                        size_t plain_count, size_t cipher_length)
+{
+    EncryptStream *stream = encrypt_stream_dup(ctx->encrypt);
+    if (stream == NULL) {
+        return OPS_ENCRYPTION_FAILED;
+    }
+
+    bool whole = ctx->config.steg_method == STEG_LSBI;
+    size_t chunk = whole ? cipher_length : LIB_CIPHER_CHUNK;
+    uint8_t *buffer = (uint8_t *)malloc(chunk + encrypt_stream_block_size(stream));
+    uint8_t length_header[4];
+    bool header_done = false;
+    size_t used = 0;
+    size_t written = 0;
+    OperationsResult rc = buffer != NULL ? OPS_OK : OPS_PAYLOAD_ALLOC_FAILED;
+
+    u32_to_be((uint32_t)cipher_length, length_header);
+
+    for (size_t i = 0; i < plain_count && rc == OPS_OK; i++) {
+        const uint8_t *in = plain[i].data;
+        size_t left = plain[i].length;
+
+        while (left > 0 && rc == OPS_OK) {
+            size_t take = left < chunk - used ? left : chunk - used;
+
+            if (encrypt_stream_update(stream, in, take, buffer + used, &written) != 0) {
+                rc = OPS_ENCRYPTION_FAILED;
+                break;
+            }
+            used += written;
+            in += take;
+            left -= take;
+
+            if (!whole && used >= chunk) {
+                rc = write_cipher(writer, length_header, &header_done, buffer, used);
+                used = 0;
+            }
+        }
+    }
+
+    if (rc == OPS_OK && encrypt_stream_final(stream, buffer + used, &written) != 0) {
+        rc = OPS_ENCRYPTION_FAILED;
+    }
+    if (rc == OPS_OK) {
+        rc = write_cipher(writer, length_header, &header_done, buffer, used + written);
+    }
+    if (rc == OPS_OK && writer->written != 4 + cipher_length) {
+        rc = OPS_ENCRYPTION_FAILED;
+    }
+
+    free(buffer);
+    encrypt_stream_free(stream);
+    return rc;
+}
+
+OperationsResult stegobmp_embed(StegobmpContext *ctx, uint8_t *bmp, size_t bmp_size,
+                                const uint8_t *data, size_t data_size, const char *extension)
+{
+    if (ctx == NULL || bmp == NULL || (data == NULL && data_size > 0)) {
+        return OPS_INVALID_ARGUMENTS;
+    }
+
+    if (extension == NULL) {
+        extension = ".bin";
+    }
+
+    size_t extension_length = strlen(extension) + 1;
+    if (extension_length > LIB_TAIL_MAX || data_size > UINT32_MAX) {
+        return OPS_INVALID_ARGUMENTS;
+    }
+
+    BMPImage image;
+    OperationsResult rc = view_carrier(bmp, bmp_size, &image);
+    if (rc != OPS_OK) {
+        return rc;
+    }
+
+    uint8_t size_header[4];
+    u32_to_be((uint32_t)data_size, size_header);
+
+    StegSegment plain[3] = {
+        { size_header, 4 },
+        { data, data_size },
+        { (const uint8_t *)extension, extension_length }
+    };
+    size_t block_length = 4 + data_size + extension_length;
+
+    if (ctx->encrypt != NULL) {
+        size_t cipher_length = encrypted_length(&ctx->config, block_length);
+        if (cipher_length == 0 || cipher_length > UINT32_MAX) {
+            return OPS_ENCRYPTION_FAILED;
+        }
+        block_length = 4 + cipher_length;
+    }
+
+    // Se verifica antes de tocar un solo píxel
+    if (block_length > steg_capacity_bytes(ctx->config.steg_method, image.width, image.height)) {
+        return OPS_CAPACITY_INSUFFICIENT;
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+
+    StegWriter writer;
+    if (steg_writer_open_memory(&writer, &image, ctx->config.steg_method, ctx->pool) != 0) {
+        rc = OPS_EMBED_FAILED;
+    } else {
+        if (ctx->encrypt == NULL) {
+            rc = steg_writer_write(&writer, plain, 3) == 0 ? OPS_OK : OPS_EMBED_FAILED;
+        } else {
+            rc = embed_encrypted(ctx, &writer, plain, 3, block_length - 4);
+        }
+        steg_writer_close(&writer);
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+/*
+ * Destino en memoria del bloque descifrado: [tamaño][datos][extension\0]
+ * (más el padding). Los datos van directo al buffer del llamador y lo que
+ * sigue queda en tail, de donde sale la extension.
+ */
+typedef struct {
+    uint8_t header[4];
+    size_t header_length;
+    size_t limit;               // Largo del cifrado: cota para el tamaño real
+    uint8_t *data;
+    size_t room;
+    size_t size;
+    size_t done;
+    uint8_t tail[LIB_TAIL_MAX];
+    size_t tail_length;
+} memory_sink_t;
+
+static OperationsResult sink_push(memory_sink_t *sink, const uint8_t *in, size_t length)
+{
+    if (sink->header_length < 4) {
+        size_t take = 4 - sink->header_length;
+        if (take > length) {
+            take = length;
+        }
+
+        memcpy(sink->header + sink->header_length, in, take);
+        sink->header_length += take;
+        in += take;
+        length -= take;
+
+        if (sink->header_length < 4) {
+            return OPS_OK;
+        }
+
+        // Con password incorrecta el tamaño es basura: se corta antes de copiar
+        sink->size = be_to_u32(sink->header);
+        if (4 + sink->size > sink->limit) {
+            return OPS_DECRYPTION_FAILED;
+        }
+        if (sink->size > sink->room) {
+            return OPS_BUFFER_TOO_SMALL;
+        }
+    }
+
+    size_t take = sink->size - sink->done;
+    if (take > length) {
+        take = length;
+    }
+    memcpy(sink->data + sink->done, in, take);
+    sink->done += take;
+    in += take;
+    length -= take;
+
+    take = sizeof(sink->tail) - sink->tail_length;
+    if (take > length) {
+        take = length;
+    }
+    memcpy(sink->tail + sink->tail_length, in, take);
+    sink->tail_length += take;
+    return OPS_OK;
+}
+
+// Extrae y descifra el cifrado por tramos, sin armar el bloque completo
+static OperationsResult extract_encrypted(StegobmpContext *ctx, StegReader *reader, size_t cipher_length,
+                                          memory_sink_t *sink)
+{
+    DecryptStream *stream = decrypt_stream_dup(ctx->decrypt);
+    if (stream == NULL) {
+        return OPS_DECRYPTION_FAILED;
+    }
+
+    uint8_t *cipher = (uint8_t *)malloc(LIB_DECRYPT_CHUNK);
+    uint8_t *plain = (uint8_t *)malloc(LIB_DECRYPT_CHUNK + decrypt_stream_block_size(stream));
+    OperationsResult rc = cipher != NULL && plain != NULL ? OPS_OK : OPS_EXTRACT_ALLOC_FAILED;
+    size_t left = cipher_length;
+    size_t written = 0;
+
+    sink->limit = cipher_length;
+
+    while (left > 0 && rc == OPS_OK) {
+        size_t take = left < LIB_DECRYPT_CHUNK ? left : LIB_DECRYPT_CHUNK;
+
+        if (steg_reader_read(reader, cipher, take) != 0) {
+            rc = OPS_EXTRACT_BLOCK_FAILED;
+        } else if (decrypt_stream_update(stream, cipher, take, plain, &written) != 0) {
+            rc = OPS_DECRYPTION_FAILED;
+        } else {
+            rc = sink_push(sink, plain, written);
+        }
+        left -= take;
+    }
+
+    if (rc == OPS_OK) {
+        rc = decrypt_stream_final(stream, plain, &written) == 0 ? sink_push(sink, plain, written)
+                                                                : OPS_DECRYPTION_FAILED;
+    }
+    if (rc == OPS_OK && (sink->header_length < 4 || sink->done < sink->size)) {
+        rc = OPS_DECRYPTION_FAILED;
+    }
+
+    free(cipher);
+    free(plain);
+    decrypt_stream_free(stream);
+    return rc;
+}
+
+// Sin cifrado los datos se extraen directo al buffer del llamador
+static OperationsResult extract_plain(StegReader *reader, size_t size, memory_sink_t *sink)
+{
+    sink->size = size;
+    if (size > sink->room) {
+        return OPS_BUFFER_TOO_SMALL;
+    }
+
+    if (steg_reader_read(reader, sink->data, size) != 0) {
+        return OPS_EXTRACT_BLOCK_FAILED;
+    }
+    sink->done = size;
+
+    size_t remaining = steg_reader_remaining(reader);
+    sink->tail_length = remaining < sizeof(sink->tail) ? remaining : sizeof(sink->tail);
+    if (steg_reader_read(reader, sink->tail, sink->tail_length) != 0) {
+        return OPS_EXTRACT_BLOCK_FAILED;
+    }
+
+    return OPS_OK;
+}
+
+OperationsResult stegobmp_extract(StegobmpContext *ctx, const uint8_t *bmp, size_t bmp_size,
+                                  uint8_t *data, size_t *data_size, char *extension, size_t extension_size)
+{
+    if (ctx == NULL || bmp == NULL || data_size == NULL || (data == NULL && *data_size > 0)) {
+        return OPS_INVALID_ARGUMENTS;
+    }
+
+    BMPImage image;
+    OperationsResult rc = view_carrier(bmp, bmp_size, &image);
+    if (rc != OPS_OK) {
+        return rc;
+    }
+
+    memory_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.data = data;
+    sink.room = *data_size;
+
+    pthread_mutex_lock(&ctx->lock);
+
+    StegReader reader;
+    uint8_t size_header[4];
+
+    if (steg_reader_open_memory(&reader, &image, ctx->config.steg_method, ctx->pool) != 0) {
+        rc = OPS_EXTRACT_SIZE_FAILED;
+    } else {
+        if (steg_reader_read(&reader, size_header, sizeof(size_header)) != 0) {
+            rc = OPS_EXTRACT_SIZE_FAILED;
+        } else if (be_to_u32(size_header) > steg_reader_remaining(&reader)) {
+            rc = OPS_EXTRACT_BLOCK_FAILED;
+        } else if (ctx->decrypt != NULL) {
+            rc = extract_encrypted(ctx, &reader, be_to_u32(size_header), &sink);
+        } else {
+            rc = extract_plain(&reader, be_to_u32(size_header), &sink);
+        }
+        steg_reader_close(&reader);
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+
+    // El tamaño se informa también cuando no entra, para reintentar con un buffer mayor
+    *data_size = rc == OPS_OK || rc == OPS_BUFFER_TOO_SMALL ? sink.size : 0;
+
+    if (rc != OPS_OK) {
+        return rc;
+    }
+
+    const uint8_t *terminator = memchr(sink.tail, '\0', sink.tail_length);
+    if (terminator == NULL) {
+        return OPS_EXTENSION_NOT_FOUND;
+    }
+
+    if (extension != NULL) {
+        size_t extension_length = (size_t)(terminator - sink.tail) + 1;
+        if (extension_length > extension_size) {
+            return OPS_BUFFER_TOO_SMALL;
+        }
+        memcpy(extension, sink.tail, extension_length);
+    }
+
+    return OPS_OK;
+}
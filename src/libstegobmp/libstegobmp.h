@@ -0,0 +1,108 @@
+#ifndef LIBSTEGOBMP_H
+#define LIBSTEGOBMP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stegobmp_types.h"
+
+/**
+ * @file libstegobmp.h
+ * @brief Library API: embed into and extract from BMP files held in memory
+ *
+ * Built as libstegobmp.a and libstegobmp.so (make lib). A context fixes the
+ * method and the encryption parameters once: the key is derived when the
+ * context is created and every call starts from a copy of that cipher state,
+ * and the kernels run on the context's own thread pool. Calls take the whole
+ * BMP file as a buffer (headers included), touch no files and print nothing
+ * to stdout; results are OperationsResult codes, as in the command line.
+ *
+ * The hidden block is the same as the command line's, so a carrier written
+ * by the library can be extracted with `stegobmp -extract` and vice versa.
+ *
+ * Only this header and stegobmp_types.h are needed to build against the library.
+ *
+ * There is no global state: contexts are independent, and calls on the same
+ * context are serialized (use one context per thread to run them in parallel).
+ */
+
+/** Marks the public entry points; everything else is hidden in libstegobmp.so */
+#if defined(__GNUC__)
+#define STEGOBMP_API __attribute__((visibility("default")))
+#else
+#define STEGOBMP_API
+#endif
+
+/** Longest extension accepted by stegobmp_embed(), without the '\0' (what extraction can recover) */
+#define STEGOBMP_EXTENSION_MAX 15
+
+typedef struct StegobmpContext StegobmpContext;
+
+/**
+ * @brief Parameters fixed for the life of a context
+ */
+typedef struct {
+    steg_method_t method;                    /**< LSB1..LSB8 or LSBI */
+    encryption_algorithm_t encryption_algo;  /**< ENC_NONE for no encryption */
+    encryption_mode_t encryption_mode;       /**< Required with an algorithm */
+    const char *password;                    /**< Required with an algorithm; copied */
+    size_t threads;                          /**< Kernel threads, 0 = online CPUs */
+} StegobmpOptions;
+
+/**
+ * @brief Creates a context, deriving the key when encryption is requested
+ *
+ * @param options Method, encryption and threads
+ *
+ * @return New context, or NULL if the options are invalid (STEG_AUTO included)
+ *         or the key could not be derived
+ */
+STEGOBMP_API StegobmpContext *stegobmp_context_create(const StegobmpOptions *options);
+
+/**
+ * @brief Wipes the key material, stops the pool and frees the context (NULL is allowed)
+ */
+STEGOBMP_API void stegobmp_context_destroy(StegobmpContext *ctx);
+
+/**
+ * @brief Hides data in a BMP file held in memory, modifying its pixels in place
+ *
+ * @param ctx Context
+ * @param bmp Whole BMP file (24 bpp, uncompressed); only pixel bytes change
+ * @param bmp_size Size of the BMP buffer in bytes
+ * @param data Bytes to hide
+ * @param data_size Number of bytes to hide
+ * @param extension Extension stored with the data (e.g. ".pdf"), NULL for ".bin"
+ *
+ * @return OPS_OK on success;
+ *         OPS_INVALID_ARGUMENTS for NULL buffers, a data size over 4 GB or a long extension;
+ *         OPS_CARRIER_READ_FAILED if the buffer is not a valid BMP;
+ *         OPS_CAPACITY_INSUFFICIENT if the block does not fit (nothing is modified);
+ *         OPS_ENCRYPTION_FAILED, OPS_PAYLOAD_ALLOC_FAILED or OPS_EMBED_FAILED otherwise
+ */
+STEGOBMP_API OperationsResult stegobmp_embed(StegobmpContext *ctx, uint8_t *bmp, size_t bmp_size,
+                                             const uint8_t *data, size_t data_size, const char *extension);
+
+/**
+ * @brief Recovers the data hidden in a BMP file held in memory into a caller buffer
+ *
+ * @param ctx Context (same method and encryption as the embed)
+ * @param bmp Whole BMP file
+ * @param bmp_size Size of the BMP buffer in bytes
+ * @param data Receives the hidden bytes
+ * @param data_size In: room in data. Out: size of the hidden data, also when it does not fit (0 on other errors)
+ * @param extension Receives the stored extension with its '\0' (NULL to ignore it)
+ * @param extension_size Room in extension; STEGOBMP_EXTENSION_MAX + 1 always fits
+ *
+ * @return OPS_OK on success;
+ *         OPS_BUFFER_TOO_SMALL if data or extension is too small (*data_size tells the data size,
+ *         so the call can be retried with a larger buffer);
+ *         OPS_INVALID_ARGUMENTS for NULL buffers;
+ *         OPS_CARRIER_READ_FAILED if the buffer is not a valid BMP;
+ *         OPS_EXTRACT_BLOCK_FAILED if the size header does not fit the carrier;
+ *         OPS_DECRYPTION_FAILED (wrong password or parameters), OPS_EXTENSION_NOT_FOUND,
+ *         OPS_EXTRACT_ALLOC_FAILED otherwise
+ */
+STEGOBMP_API OperationsResult stegobmp_extract(StegobmpContext *ctx, const uint8_t *bmp, size_t bmp_size,
+                                               uint8_t *data, size_t *data_size, char *extension, size_t extension_size);
+
+#endif // LIBSTEGOBMP_H
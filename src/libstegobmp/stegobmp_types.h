@@ -0,0 +1,62 @@
+#ifndef STEGOBMP_TYPES_H
+#define STEGOBMP_TYPES_H
+
+/**
+ * @file stegobmp_types.h
+ * @brief Method, encryption and result types shared by the command line and libstegobmp
+ *
+ * Self-contained so it can be installed next to libstegobmp.h.
+ */
+
+typedef enum {
+    STEG_NONE = 0,
+    STEG_LSB1,
+    STEG_LSB4,
+    STEG_LSBI,
+    STEG_LSB2,
+    STEG_LSB3,
+    STEG_LSB5,
+    STEG_LSB6,
+    STEG_LSB7,
+    STEG_LSB8,
+    STEG_AUTO   // Picked per carrier and payload on embed, detected on extract
+} steg_method_t;
+
+typedef enum {
+    ENC_NONE = 0,
+    ENC_AES128,
+    ENC_AES192,
+    ENC_AES256,
+    ENC_3DES
+} encryption_algorithm_t;
+
+typedef enum {
+    MODE_NONE = 0,
+    MODE_ECB,
+    MODE_CFB,
+    MODE_OFB,
+    MODE_CBC
+} encryption_mode_t;
+
+typedef enum {
+    OPS_OK = 0,
+    OPS_INVALID_STEG_METHOD,
+    OPS_INPUT_READ_FAILED,
+    OPS_PAYLOAD_ALLOC_FAILED,
+    OPS_CAPACITY_INSUFFICIENT,
+    OPS_EMBED_FAILED,
+    OPS_BMP_WRITE_FAILED,
+
+    OPS_EXTRACT_SIZE_FAILED,
+    OPS_EXTRACT_ALLOC_FAILED,
+    OPS_EXTRACT_BLOCK_FAILED,
+    OPS_EXTENSION_NOT_FOUND,
+    OPS_OUTPUT_WRITE_FAILED,
+    OPS_ENCRYPTION_FAILED,
+    OPS_DECRYPTION_FAILED,
+    OPS_CARRIER_READ_FAILED,
+    OPS_INVALID_ARGUMENTS,
+    OPS_BUFFER_TOO_SMALL     // Caller buffer too small (libstegobmp): retry with the reported size
+} OperationsResult;
+
+#endif // STEGOBMP_TYPES_H
@@ -1,35 +1,145 @@
 #include "lsb1.h"
+#include "lsb1_simd.h"
 #include "../common/bmp_image.h"
+#include "../common/cpu_features.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
-int lsb1_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
-    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
-        return -1;
+/*
+ * Motor por palabras: un byte de payload ocupa 8 componentes consecutivos, así
+ * que dentro de una fila se procesa de a 8 componentes con un uint64_t. Los
+ * bits que no completan un byte (inicio/fin de fila, num_bits no múltiplo de 8)
+ * se resuelven de a uno. Los bytes completos pasan por el kernel elegido al
+ * arrancar según la CPU (SWAR, SSE2 o AVX2; ver lsb1_simd.h).
+ */
+
+#define LSB1_LSB_MASK 0x0101010101010101ULL
+
+// Bit i del byte (desde el MSB) en el LSB del byte i de la palabra (orden de memoria)
+#define SPREAD(b) ((uint64_t)(((b) >> 7) & 1)         | (uint64_t)(((b) >> 6) & 1) << 8  | \
+                   (uint64_t)(((b) >> 5) & 1) << 16   | (uint64_t)(((b) >> 4) & 1) << 24 | \
+                   (uint64_t)(((b) >> 3) & 1) << 32   | (uint64_t)(((b) >> 2) & 1) << 40 | \
+                   (uint64_t)(((b) >> 1) & 1) << 48   | (uint64_t)((b) & 1) << 56)
+#define SPREAD4(b)  SPREAD(b), SPREAD((b) + 1), SPREAD((b) + 2), SPREAD((b) + 3)
+#define SPREAD16(b) SPREAD4(b), SPREAD4((b) + 4), SPREAD4((b) + 8), SPREAD4((b) + 12)
+#define SPREAD64(b) SPREAD16(b), SPREAD16((b) + 16), SPREAD16((b) + 32), SPREAD16((b) + 48)
+
+static const uint64_t spread_table[256] = {
+    SPREAD64(0), SPREAD64(64), SPREAD64(128), SPREAD64(192)
+};
+
+// Multiplicador que junta los LSB de los 8 bytes en el byte alto, el primero como MSB
+#define LSB1_GATHER_MUL 0x8040201008040201ULL
+
+static inline uint64_t load_le64(const uint8_t *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+static inline void store_le64(uint8_t *p, uint64_t w) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    memcpy(p, &w, sizeof(w));
+}
+
+void lsb1_embed_bytes_scalar(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    for (size_t i = 0; i < nbytes; i++, dst += 8) {
+        uint64_t w = load_le64(dst);
+        store_le64(dst, (w & ~LSB1_LSB_MASK) | spread_table[src[i]]);
+    }
+}
+
+void lsb1_extract_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    for (size_t i = 0; i < nbytes; i++, src += 8) {
+        dst[i] = (uint8_t)(((load_le64(src) & LSB1_LSB_MASK) * LSB1_GATHER_MUL) >> 56);
     }
+}
 
-    size_t component_index = *offset;
-    size_t bit_index = 0;
-    size_t max_component_index = bmp->width * bmp->height * 3;
+static lsb1_embed_bytes_fn embed_bytes = lsb1_embed_bytes_scalar;
+static lsb1_extract_bytes_fn extract_bytes = lsb1_extract_bytes_scalar;
+
+__attribute__((constructor))
+static void select_kernels(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    cpu_simd_level_t level = cpu_simd_level();
+
+    if (level >= CPU_SIMD_AVX2) {
+        embed_bytes = lsb1_embed_bytes_avx2;
+        extract_bytes = lsb1_extract_bytes_avx2;
+    } else if (level >= CPU_SIMD_SSE2) {
+        embed_bytes = lsb1_embed_bytes_sse2;
+        extract_bytes = lsb1_extract_bytes_sse2;
+    }
+#endif
+}
+
+// Oculta count bits de data (desde el bit first_bit) en count componentes contiguos
+static void embed_span(uint8_t *dst, const uint8_t *data, size_t first_bit, size_t count) {
+    size_t bit_index = first_bit;
+    size_t end = first_bit + count;
+
+    for (; bit_index < end && bit_index % 8 != 0; bit_index++, dst++) {
+        uint8_t bit = (data[bit_index / 8] >> (7 - bit_index % 8)) & 0x01;
+        *dst = (*dst & 0xFE) | bit;
+    }
+
+    size_t nbytes = (end - bit_index) / 8;
+    embed_bytes(dst, data + bit_index / 8, nbytes);
+    bit_index += nbytes * 8;
+    dst += nbytes * 8;
 
-    for (; bit_index < num_bits && component_index < max_component_index; bit_index++) {
-        Component comp = get_component_by_index(bmp, component_index++);
-        if (comp.component_ptr == NULL) {
-            return -1;
-        }
+    for (; bit_index < end; bit_index++, dst++) {
+        uint8_t bit = (data[bit_index / 8] >> (7 - bit_index % 8)) & 0x01;
+        *dst = (*dst & 0xFE) | bit;
+    }
+}
 
-        uint8_t byte = data[bit_index / 8];
-        size_t bit_position = 7 - (bit_index % 8);
-        uint8_t bit = (byte >> bit_position) & 0x01;
+// Extrae count bits de count componentes contiguos hacia buffer (desde el bit first_bit, ya en cero)
+static void extract_span(const uint8_t *src, uint8_t *buffer, size_t first_bit, size_t count) {
+    size_t bit_index = first_bit;
+    size_t end = first_bit + count;
 
-        *comp.component_ptr = (*comp.component_ptr & 0xFE) | bit;
+    for (; bit_index < end && bit_index % 8 != 0; bit_index++, src++) {
+        buffer[bit_index / 8] |= (uint8_t)((*src & 0x01) << (7 - bit_index % 8));
     }
 
-    if (bit_index != num_bits) {
+    size_t nbytes = (end - bit_index) / 8;
+    extract_bytes(src, buffer + bit_index / 8, nbytes);
+    bit_index += nbytes * 8;
+    src += nbytes * 8;
+
+    for (; bit_index < end; bit_index++, src++) {
+        buffer[bit_index / 8] |= (uint8_t)((*src & 0x01) << (7 - bit_index % 8));
+    }
+}
+
+int lsb1_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
+        return -1;
+    }
+
+    if (lsb1_capacity_bits(bmp, *offset) < num_bits) {
         return -1;
     }
 
-    *offset = component_index;
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_index = 0;
+
+    // Tramos contiguos sin padding (uno solo si las filas no tienen padding)
+    bmp_span_cursor_init(&cursor, bmp, *offset, num_bits);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        embed_span(span.ptr, data, bit_index, span.len);
+        bit_index += span.len;
+    }
+
+    *offset = cursor.next;
     return 0;
 }
 
@@ -40,26 +150,33 @@ int lsb1_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *
 
     memset(buffer, 0, (num_bits + 7) / 8);
 
-    size_t component_index = *offset;
+    if (lsb1_capacity_bits(bmp, *offset) < num_bits) {
+        return -1;
+    }
+
+    BMPSpanCursor cursor;
+    BMPSpan span;
     size_t bit_index = 0;
-    size_t max_component_index = bmp->width * bmp->height * 3;
 
-    for (; bit_index < num_bits && component_index < max_component_index; component_index++) {
-        Component comp = get_component_by_index(bmp, component_index);
-        if (comp.component_ptr == NULL) {
-            return -1;
-        }
+    bmp_span_cursor_init(&cursor, bmp, *offset, num_bits);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        extract_span(span.ptr, buffer, bit_index, span.len);
+        bit_index += span.len;
+    }
 
-        uint8_t bit = *comp.component_ptr & 0x01;
-        size_t bit_position = 7 - (bit_index % 8);
-        buffer[bit_index / 8] |= (bit << bit_position);
-        bit_index++;
+    *offset = cursor.next;
+    return 0;
+}
+
+size_t lsb1_capacity_bits(const BMPImage *bmp, size_t offset) {
+    if (bmp == NULL) {
+        return 0;
     }
 
-    if (bit_index != num_bits) {
-        return -1;
+    size_t max_component_index = bmp->width * bmp->height * 3;
+    if (offset >= max_component_index) {
+        return 0;
     }
 
-    *offset = component_index;
-    return 0;
+    return (max_component_index - offset);
 }
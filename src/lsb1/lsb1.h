@@ -21,6 +21,8 @@
  * @note The function modifies the pixel data in place
  * @note Requires at least num_bits components to embed num_bits bits
  * @note Each data bit requires 1 component (1 bit per component)
+ * @note Whole payload bytes are written 8 components at a time within each row
+ * @note Nothing is modified if the image cannot hold num_bits from offset
  */
 int lsb1_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset);
 
@@ -40,7 +42,18 @@ int lsb1_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offs
  * @note The output buffer must be pre-allocated with sufficient space
  * @note Extracts exactly num_bits bits from the pixel data
  * @note Each extracted bit comes from 1 consecutive component
+ * @note Whole payload bytes are gathered from 8 components at a time within each row
  */
 int lsb1_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *offset);
 
+/**
+ * @brief Number of data bits LSB1 can hold from a component index to the end of the image
+ * 
+ * @param bmp Pointer to BMPImage structure
+ * @param offset Starting component index
+ * 
+ * @return One bit per component over [offset, width * height * 3)
+ */
+size_t lsb1_capacity_bits(const BMPImage *bmp, size_t offset);
+
 #endif // LSB1_H
@@ -0,0 +1,103 @@
+#include "lsb1_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/*
+ * Embed: cada byte de payload se replica en 8 carriles, se aísla el bit del
+ * carril (0x80 en el primero ... 0x01 en el octavo) y se mezcla con el
+ * componente sin su LSB. Extract: el LSB de cada carril se lleva al bit de
+ * signo y pmovmskb junta un bit por carril.
+ */
+
+// Bits invertidos de un byte: movemask deja el primer componente en el LSB
+static const uint8_t bit_reverse[256] = {
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+    R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+};
+
+__attribute__((target("sse2")))
+void lsb1_embed_bytes_sse2(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    const __m128i bit_select = _mm_set_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80);
+    const __m128i ones = _mm_set1_epi8(0x01);
+    const __m128i keep = _mm_set1_epi8((char)0xFE);
+    size_t i = 0;
+
+    for (; i + 2 <= nbytes; i += 2, dst += 16) {
+        // [b0 x8, b1 x8]
+        __m128i v = _mm_cvtsi32_si128(src[i] | (src[i + 1] << 8));
+        v = _mm_unpacklo_epi8(v, v);
+        v = _mm_unpacklo_epi16(v, v);
+        v = _mm_unpacklo_epi32(v, v);
+
+        __m128i bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, bit_select), bit_select), ones);
+        __m128i carrier = _mm_loadu_si128((const __m128i *)dst);
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(carrier, keep), bits));
+    }
+
+    lsb1_embed_bytes_scalar(dst, src + i, nbytes - i);
+}
+
+__attribute__((target("sse2")))
+void lsb1_extract_bytes_sse2(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    size_t i = 0;
+
+    for (; i + 2 <= nbytes; i += 2, src += 16) {
+        __m128i carrier = _mm_loadu_si128((const __m128i *)src);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_slli_epi16(carrier, 7));
+        dst[i] = bit_reverse[mask & 0xFF];
+        dst[i + 1] = bit_reverse[mask >> 8];
+    }
+
+    lsb1_extract_bytes_scalar(src, dst + i, nbytes - i);
+}
+
+__attribute__((target("avx2")))
+void lsb1_embed_bytes_avx2(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bit_select = _mm256_set1_epi64x((long long)0x0102040810204080ULL);
+    const __m256i ones = _mm256_set1_epi8(0x01);
+    const __m256i keep = _mm256_set1_epi8((char)0xFE);
+    size_t i = 0;
+
+    for (; i + 4 <= nbytes; i += 4, dst += 32) {
+        int32_t word;
+        __builtin_memcpy(&word, src + i, sizeof(word));
+
+        // [b0 x8, b1 x8 | b2 x8, b3 x8]
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(word), spread);
+        __m256i bits = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(v, bit_select), bit_select), ones);
+        __m256i carrier = _mm256_loadu_si256((const __m256i *)dst);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(_mm256_and_si256(carrier, keep), bits));
+    }
+
+    lsb1_embed_bytes_sse2(dst, src + i, nbytes - i);
+}
+
+__attribute__((target("avx2")))
+void lsb1_extract_bytes_avx2(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    // Invierte cada grupo de 8 componentes para que el primero quede en el MSB del byte de máscara
+    const __m256i reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t i = 0;
+
+    for (; i + 4 <= nbytes; i += 4, src += 32) {
+        __m256i carrier = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)src), reverse);
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_slli_epi16(carrier, 7));
+        dst[i] = (uint8_t)mask;
+        dst[i + 1] = (uint8_t)(mask >> 8);
+        dst[i + 2] = (uint8_t)(mask >> 16);
+        dst[i + 3] = (uint8_t)(mask >> 24);
+    }
+
+    lsb1_extract_bytes_sse2(src, dst + i, nbytes - i);
+}
+
+#endif
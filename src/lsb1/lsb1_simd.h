@@ -0,0 +1,36 @@
+#ifndef LSB1_SIMD_H
+#define LSB1_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file lsb1_simd.h
+ * @brief Whole-byte LSB1 kernels used by lsb1_embed()/lsb1_extract()
+ * 
+ * Each kernel works on nbytes payload bytes and 8 * nbytes contiguous carrier
+ * components (a span inside one row). All variants produce identical output;
+ * lsb1.c picks one at startup according to cpu_simd_level().
+ */
+
+/** Writes the bits of src[0..nbytes) into the LSBs of dst[0..8 * nbytes) */
+typedef void (*lsb1_embed_bytes_fn)(uint8_t *dst, const uint8_t *src, size_t nbytes);
+
+/** Gathers the LSBs of src[0..8 * nbytes) into dst[0..nbytes) */
+typedef void (*lsb1_extract_bytes_fn)(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+/** Portable 64-bit (SWAR) kernels */
+void lsb1_embed_bytes_scalar(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb1_extract_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+#if defined(__x86_64__) || defined(__i386__)
+/** SSE2 kernels: 2 payload bytes (16 components) per step */
+void lsb1_embed_bytes_sse2(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb1_extract_bytes_sse2(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+/** AVX2 kernels: 4 payload bytes (32 components) per step */
+void lsb1_embed_bytes_avx2(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb1_extract_bytes_avx2(const uint8_t *src, uint8_t *dst, size_t nbytes);
+#endif
+
+#endif // LSB1_SIMD_H
@@ -1,46 +1,120 @@
 #include "lsb4.h"
+#include "lsb4_simd.h"
 #include "../common/bmp_image.h"
+#include "../common/cpu_features.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
-int lsb4_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
-    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
-        return -1;
+/*
+ * Cada byte de payload ocupa 2 componentes consecutivos (nibble alto, nibble
+ * bajo), así que dentro de una fila los bytes completos pasan por el kernel
+ * elegido al arrancar según la CPU (ver lsb4_simd.h). Un byte partido entre
+ * dos filas (ancho impar) se resuelve de a un nibble.
+ */
+
+void lsb4_embed_bytes_scalar(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    for (size_t i = 0; i < nbytes; i++, dst += 2) {
+        dst[0] = (uint8_t)((dst[0] & 0xF0) | (src[i] >> 4));
+        dst[1] = (uint8_t)((dst[1] & 0xF0) | (src[i] & 0x0F));
     }
+}
 
-    if (num_bits % 4 != 0) {
-        return -1;
+void lsb4_extract_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    for (size_t i = 0; i < nbytes; i++, src += 2) {
+        dst[i] = (uint8_t)(((src[0] & 0x0F) << 4) | (src[1] & 0x0F));
     }
+}
 
-    size_t component_index = *offset;
-    size_t bit_index = 0;
-    size_t max_component_index = bmp->width * bmp->height * 3;
+static lsb4_embed_bytes_fn embed_bytes = lsb4_embed_bytes_scalar;
+static lsb4_extract_bytes_fn extract_bytes = lsb4_extract_bytes_scalar;
+
+__attribute__((constructor))
+static void select_kernels(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    cpu_simd_level_t level = cpu_simd_level();
+
+    if (level >= CPU_SIMD_AVX2) {
+        embed_bytes = lsb4_embed_bytes_avx2;
+        extract_bytes = lsb4_extract_bytes_avx2;
+    } else if (level >= CPU_SIMD_SSE2) {
+        embed_bytes = lsb4_embed_bytes_sse2;
+        extract_bytes = lsb4_extract_bytes_sse2;
+    }
+#endif
+}
+
+static inline uint8_t nibble_at(const uint8_t *data, size_t bit_index) {
+    return (uint8_t)((data[bit_index / 8] >> (bit_index % 8 == 0 ? 4 : 0)) & 0x0F);
+}
+
+// Oculta count nibbles de data (desde el bit first_bit, múltiplo de 4) en count componentes contiguos
+static void embed_span(uint8_t *dst, const uint8_t *data, size_t first_bit, size_t count) {
+    size_t bit_index = first_bit;
+    size_t end = first_bit + count * 4;
+
+    if (bit_index < end && bit_index % 8 != 0) {
+        *dst = (uint8_t)((*dst & 0xF0) | nibble_at(data, bit_index));
+        bit_index += 4;
+        dst++;
+    }
 
-    for (; bit_index < num_bits && component_index < max_component_index; bit_index += 4) {
-        uint8_t byte = data[bit_index / 8];
-        size_t start_bit_position = 7 - (bit_index % 8);
-        uint8_t bits_value = 0;
+    size_t nbytes = (end - bit_index) / 8;
+    embed_bytes(dst, data + bit_index / 8, nbytes);
+    bit_index += nbytes * 8;
+    dst += nbytes * 2;
 
-        // Extraemos los 4 bits
-        for (int bit = 0; bit < 4; bit++) {
-            size_t current_bit_position = start_bit_position - bit;
-            bits_value |= ((byte >> current_bit_position) & 0x01) << (3 - bit);
-        }
+    if (bit_index < end) {
+        *dst = (uint8_t)((*dst & 0xF0) | nibble_at(data, bit_index));
+    }
+}
+
+// Extrae count nibbles de count componentes contiguos hacia buffer (desde el bit first_bit, ya en cero)
+static void extract_span(const uint8_t *src, uint8_t *buffer, size_t first_bit, size_t count) {
+    size_t bit_index = first_bit;
+    size_t end = first_bit + count * 4;
 
-        Component comp = get_component_by_index(bmp, component_index++);
-        if (comp.component_ptr == NULL) {
-            return -1;
-        }
+    if (bit_index < end && bit_index % 8 != 0) {
+        buffer[bit_index / 8] |= (uint8_t)(*src & 0x0F);
+        bit_index += 4;
+        src++;
+    }
+
+    size_t nbytes = (end - bit_index) / 8;
+    extract_bytes(src, buffer + bit_index / 8, nbytes);
+    bit_index += nbytes * 8;
+    src += nbytes * 2;
 
-        // Colocar los 4 bits en los menos significativos del componente
-        *comp.component_ptr = (*comp.component_ptr & 0xF0) | bits_value;
+    if (bit_index < end) {
+        buffer[bit_index / 8] |= (uint8_t)((*src & 0x0F) << 4);
     }
+}
 
-    if (bit_index != num_bits) {
+int lsb4_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
+        return -1;
+    }
+
+    if (num_bits % 4 != 0) {
         return -1;
     }
 
-    *offset = component_index;
+    if (lsb4_capacity_bits(bmp, *offset) < num_bits) {
+        return -1;
+    }
+
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_index = 0;
+
+    // Tramos contiguos sin padding (uno solo si las filas no tienen padding)
+    bmp_span_cursor_init(&cursor, bmp, *offset, num_bits / 4);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        embed_span(span.ptr, data, bit_index, span.len);
+        bit_index += span.len * 4;
+    }
+
+    *offset = cursor.next;
     return 0;
 }
 
@@ -55,30 +129,33 @@ int lsb4_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *
 
     memset(buffer, 0, (num_bits + 7) / 8);
 
-    size_t component_index = *offset;
+    if (lsb4_capacity_bits(bmp, *offset) < num_bits) {
+        return -1;
+    }
+
+    BMPSpanCursor cursor;
+    BMPSpan span;
     size_t bit_index = 0;
-    size_t max_component_index = bmp->width * bmp->height * 3;
 
-    for (; bit_index < num_bits && component_index < max_component_index; bit_index += 4) {
-        Component comp = get_component_by_index(bmp, component_index++);
-        if (comp.component_ptr == NULL) {
-            return -1;
-        }
+    bmp_span_cursor_init(&cursor, bmp, *offset, num_bits / 4);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        extract_span(span.ptr, buffer, bit_index, span.len);
+        bit_index += span.len * 4;
+    }
 
-        uint8_t extracted_bits = *comp.component_ptr & 0x0F;
+    *offset = cursor.next;
+    return 0;
+}
 
-        // Almacenar los 4 bits extraídos en el buffer
-        for (int bit = 3; bit >= 0; bit--) {
-            uint8_t bit_value = (extracted_bits >> bit) & 0x01;
-            size_t bit_position = 7 - ((bit_index + (3 - bit)) % 8);
-            buffer[(bit_index + (3 - bit)) / 8] |= (bit_value << bit_position);
-        }
+size_t lsb4_capacity_bits(const BMPImage *bmp, size_t offset) {
+    if (bmp == NULL) {
+        return 0;
     }
 
-    if (bit_index != num_bits) {
-        return -1;
+    size_t max_component_index = bmp->width * bmp->height * 3;
+    if (offset >= max_component_index) {
+        return 0;
     }
 
-    *offset = component_index;
-    return 0;
+    return (max_component_index - offset) * 4;
 }
@@ -21,6 +21,7 @@
  * @note The function modifies the pixel data in place
  * @note Requires at least num_bits / 4 components to embed num_bits bits
  * @note Each data byte requires 2 components (4 bits per component)
+ * @note Nothing is modified if the image cannot hold num_bits from offset
  */
 int lsb4_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset);
 
@@ -43,5 +44,15 @@ int lsb4_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offs
  */
 int lsb4_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *offset);
 
+/**
+ * @brief Number of data bits LSB4 can hold from a component index to the end of the image
+ * 
+ * @param bmp Pointer to BMPImage structure
+ * @param offset Starting component index
+ * 
+ * @return Four bits per component over [offset, width * height * 3)
+ */
+size_t lsb4_capacity_bits(const BMPImage *bmp, size_t offset);
+
 #endif // LSB4_H
 
@@ -0,0 +1,94 @@
+#include "lsb4_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/*
+ * Embed: se separan los nibbles alto y bajo de cada byte y se intercalan con
+ * unpack (alto, bajo, alto, bajo, ...) sobre los componentes sin su nibble bajo.
+ * Extract: cada par de componentes es una palabra de 16 bits; se juntan los
+ * dos nibbles en el byte bajo y packus deja un byte de payload por palabra.
+ */
+
+__attribute__((target("sse2")))
+void lsb4_embed_bytes_sse2(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i keep = _mm_set1_epi8((char)0xF0);
+    size_t i = 0;
+
+    for (; i + 16 <= nbytes; i += 16, dst += 32) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        __m128i lo = _mm_and_si128(v, nibble);
+
+        __m128i c0 = _mm_loadu_si128((const __m128i *)dst);
+        __m128i c1 = _mm_loadu_si128((const __m128i *)(dst + 16));
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(c0, keep), _mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_or_si128(_mm_and_si128(c1, keep), _mm_unpackhi_epi8(hi, lo)));
+    }
+
+    lsb4_embed_bytes_scalar(dst, src + i, nbytes - i);
+}
+
+__attribute__((target("sse2")))
+void lsb4_extract_bytes_sse2(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    const __m128i nibbles = _mm_set1_epi8(0x0F);
+    const __m128i low_byte = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+
+    for (; i + 16 <= nbytes; i += 16, src += 32) {
+        __m128i w0 = _mm_and_si128(_mm_loadu_si128((const __m128i *)src), nibbles);
+        __m128i w1 = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 16)), nibbles);
+
+        // byte bajo de cada palabra: (primer componente << 4) | segundo componente
+        w0 = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(w0, 4), _mm_srli_epi16(w0, 8)), low_byte);
+        w1 = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(w1, 4), _mm_srli_epi16(w1, 8)), low_byte);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(w0, w1));
+    }
+
+    lsb4_extract_bytes_scalar(src, dst + i, nbytes - i);
+}
+
+__attribute__((target("avx2")))
+void lsb4_embed_bytes_avx2(uint8_t *dst, const uint8_t *src, size_t nbytes) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i keep = _mm256_set1_epi8((char)0xF0);
+    size_t i = 0;
+
+    for (; i + 32 <= nbytes; i += 32, dst += 64) {
+        // unpack trabaja por carril de 128 bits: bytes 0-7 y 16-23 al primer carril
+        __m256i v = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(src + i)), 0xD8);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        __m256i lo = _mm256_and_si256(v, nibble);
+
+        __m256i c0 = _mm256_loadu_si256((const __m256i *)dst);
+        __m256i c1 = _mm256_loadu_si256((const __m256i *)(dst + 32));
+        _mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(_mm256_and_si256(c0, keep), _mm256_unpacklo_epi8(hi, lo)));
+        _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_or_si256(_mm256_and_si256(c1, keep), _mm256_unpackhi_epi8(hi, lo)));
+    }
+
+    lsb4_embed_bytes_sse2(dst, src + i, nbytes - i);
+}
+
+__attribute__((target("avx2")))
+void lsb4_extract_bytes_avx2(const uint8_t *src, uint8_t *dst, size_t nbytes) {
+    const __m256i nibbles = _mm256_set1_epi8(0x0F);
+    const __m256i low_byte = _mm256_set1_epi16(0x00FF);
+    size_t i = 0;
+
+    for (; i + 32 <= nbytes; i += 32, src += 64) {
+        __m256i w0 = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)src), nibbles);
+        __m256i w1 = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src + 32)), nibbles);
+
+        w0 = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(w0, 4), _mm256_srli_epi16(w0, 8)), low_byte);
+        w1 = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(w1, 4), _mm256_srli_epi16(w1, 8)), low_byte);
+
+        // packus intercala por carril: se reordenan los cuartos de 64 bits
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(w0, w1), 0xD8);
+        _mm256_storeu_si256((__m256i *)(dst + i), packed);
+    }
+
+    lsb4_extract_bytes_sse2(src, dst + i, nbytes - i);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef LSB4_SIMD_H
+#define LSB4_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file lsb4_simd.h
+ * @brief Whole-byte LSB4 kernels used by lsb4_embed()/lsb4_extract()
+ * 
+ * Each kernel works on nbytes payload bytes and 2 * nbytes contiguous carrier
+ * components (a span inside one row): the high nibble goes to the first
+ * component, the low nibble to the second. All variants produce identical
+ * output; lsb4.c picks one at startup according to cpu_simd_level().
+ */
+
+/** Writes src[0..nbytes) into the low nibbles of dst[0..2 * nbytes) */
+typedef void (*lsb4_embed_bytes_fn)(uint8_t *dst, const uint8_t *src, size_t nbytes);
+
+/** Packs the low nibbles of src[0..2 * nbytes) into dst[0..nbytes) */
+typedef void (*lsb4_extract_bytes_fn)(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+/** Portable kernels */
+void lsb4_embed_bytes_scalar(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb4_extract_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+#if defined(__x86_64__) || defined(__i386__)
+/** SSE2 kernels: 16 payload bytes (32 components) per step */
+void lsb4_embed_bytes_sse2(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb4_extract_bytes_sse2(const uint8_t *src, uint8_t *dst, size_t nbytes);
+
+/** AVX2 kernels: 32 payload bytes (64 components) per step */
+void lsb4_embed_bytes_avx2(uint8_t *dst, const uint8_t *src, size_t nbytes);
+void lsb4_extract_bytes_avx2(const uint8_t *src, uint8_t *dst, size_t nbytes);
+#endif
+
+#endif // LSB4_SIMD_H
@@ -1,78 +1,243 @@
+
 #include "lsbi.h"
+#include "lsbi_simd.h"
 #include "../common/bmp_image.h"
+#include "../common/cpu_features.h"
 #include "../lsb1/lsb1.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-int lsbi_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
-    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
-        return -1;
+/*
+ * Los tramos recorren los componentes en orden y se saltean los rojos. Cuando
+ * el próximo bit del payload empieza un byte, los bloques completos del tramo
+ * pasan por el kernel vectorial elegido al arrancar (ver lsbi_simd.h); el resto
+ * se procesa de a un componente.
+ */
+static lsbi_histogram_blocks_fn histogram_blocks = NULL;
+static lsbi_embed_blocks_fn embed_blocks = NULL;
+static lsbi_extract_blocks_fn extract_blocks = NULL;
+
+// Bit recuperado por pattern map y valor del componente: LSB, invertido si su patrón está marcado
+static uint8_t recovered_bit[1 << PATTERN_MAP_SIZE][256];
+
+// Posiciones verde/azul en 4 píxeles (12 componentes) según el color del primero
+static const uint8_t gb_offsets[3][8] = {
+    {0, 1, 3, 4, 6, 7, 9, 10},   // azul primero
+    {0, 2, 3, 5, 6, 8, 9, 11},   // verde primero
+    {1, 2, 4, 5, 7, 8, 10, 11}   // rojo primero
+};
+
+__attribute__((constructor))
+static void select_kernels(void) {
+    for (int map = 0; map < (1 << PATTERN_MAP_SIZE); map++) {
+        for (int c = 0; c < 256; c++) {
+            int pattern = (c >> 1) & 0x03;
+            recovered_bit[map][c] = (uint8_t)((c & 0x01) ^ ((map >> (3 - pattern)) & 0x01));
+        }
     }
 
-    size_t component_index = *offset + PATTERN_MAP_SIZE; 
-    size_t bit_to_embed_count = 0;
-    size_t pattern_changed[PATTERN_MAP_SIZE] = {0};
-    size_t pattern_unchanged[PATTERN_MAP_SIZE] = {0};
-    size_t max_component_index = bmp->width * bmp->height * 3;
+#if defined(__x86_64__) || defined(__i386__)
+    cpu_simd_level_t level = cpu_simd_level();
 
-    if (component_index + num_bits > max_component_index) {
-        return -1;
+    if (level >= CPU_SIMD_AVX2) {
+        histogram_blocks = lsbi_histogram_blocks_avx2;
+        embed_blocks = lsbi_embed_blocks_avx2;
+    } else if (level >= CPU_SIMD_SSSE3) {
+        histogram_blocks = lsbi_histogram_blocks_ssse3;
+        embed_blocks = lsbi_embed_blocks_ssse3;
     }
 
+    if (level >= CPU_SIMD_SSSE3) {
+        extract_blocks = lsbi_extract_blocks_ssse3;
+    }
+#endif
+}
 
-    for (; component_index < max_component_index && bit_to_embed_count < num_bits; component_index++) {
-        Component comp = get_component_by_index(bmp, component_index);
-        if (comp.component_ptr == NULL || (comp.color != GREEN && comp.color != BLUE)) continue;
+// Extrae bytes completos de a 12 componentes (8 verde/azul); devuelve los componentes consumidos
+static size_t extract_bytes(const uint8_t *ptr, size_t len, unsigned phase, uint8_t *out, const uint8_t table[256]) {
+    const uint8_t *pos = gb_offsets[phase];
+    size_t done = 0;
 
-        uint8_t original_component = *comp.component_ptr;
-        uint8_t pattern = (original_component >> 1) & 0x03;
+    for (; len - done >= 12; done += 12, out++) {
+        const uint8_t *c = ptr + done;
+        *out = (uint8_t)(table[c[pos[0]]] << 7 | table[c[pos[1]]] << 6 | table[c[pos[2]]] << 5 | table[c[pos[3]]] << 4 |
+                         table[c[pos[4]]] << 3 | table[c[pos[5]]] << 2 | table[c[pos[6]]] << 1 | table[c[pos[7]]]);
+    }
 
-        uint8_t bit = (data[bit_to_embed_count / 8] >> (7 - (bit_to_embed_count % 8))) & 0x01;
+    return done;
+}
 
-        *comp.component_ptr = (original_component & 0xFE) | bit;
+static inline uint8_t data_bit(const uint8_t *data, size_t bit_index) {
+    return (data[bit_index / 8] >> (7 - (bit_index % 8))) & 0x01;
+}
 
-        if (*comp.component_ptr != original_component) {
-            pattern_changed[pattern]++;
-        } else {
-            pattern_unchanged[pattern]++;
-        }
+/*
+ * Uno después del componente verde/azul que guarda el último de num_bits bits
+ * a partir de start. El color solo depende de index % 3: en [0, n) hay
+ * n - n / 3 componentes no rojos y el j-ésimo (desde 0) es el índice j + j / 2.
+ */
+static size_t gb_end_component(size_t start, size_t num_bits) {
+    if (num_bits == 0) {
+        return start;
+    }
+
+    size_t last = (start - start / 3) + num_bits - 1;
+    return last + last / 2 + 1;
+}
+
+// Prepara el cursor sobre los componentes que usan num_bits bits; -1 si no entran
+static int gb_cursor_init(BMPSpanCursor *cursor, const BMPImage *bmp, size_t offset, size_t num_bits) {
+    size_t end = gb_end_component(offset, num_bits);
+
+    if (end > bmp->width * bmp->height * 3) {
+        return -1;
+    }
+
+    bmp_span_cursor_init(cursor, bmp, offset, end - offset);
+    return 0;
+}
 
-        bit_to_embed_count++;
+int lsbi_histogram(const BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset,
+                   size_t pattern_changed[PATTERN_MAP_SIZE], size_t pattern_unchanged[PATTERN_MAP_SIZE]) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL ||
+        pattern_changed == NULL || pattern_unchanged == NULL) {
+        return -1;
     }
 
-    if (bit_to_embed_count < num_bits) {
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_count = 0;
+
+    if (gb_cursor_init(&cursor, bmp, *offset, num_bits) != 0) {
         return -1;
     }
 
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        size_t color = span.component % 3;
+        size_t i = 0;
+
+        while (i < span.len) {
+            if (histogram_blocks != NULL && bit_count % 8 == 0 && span.len - i >= LSBI_SIMD_BLOCK) {
+                size_t done = histogram_blocks(span.ptr + i, span.len - i, (unsigned)color, data + bit_count / 8,
+                                               pattern_changed, pattern_unchanged);
+                i += done;
+                bit_count += done / 3 * 2;
+                continue;
+            }
+
+            if (color != RED) {
+                uint8_t component = span.ptr[i];
+                uint8_t pattern = (component >> 1) & 0x03;
+
+                // Solo contamos: el portador no se modifica en esta pasada
+                if ((component & 0x01) != data_bit(data, bit_count)) {
+                    pattern_changed[pattern]++;
+                } else {
+                    pattern_unchanged[pattern]++;
+                }
+
+                bit_count++;
+            }
+
+            if (++color == 3) {
+                color = 0;
+            }
+            i++;
+        }
+    }
+
+    *offset = cursor.next;
+    return 0;
+}
+
+uint8_t lsbi_pattern_map(const size_t pattern_changed[PATTERN_MAP_SIZE], const size_t pattern_unchanged[PATTERN_MAP_SIZE]) {
     uint8_t pattern_map = 0;
+
+    // El patrón 00 va en el bit más significativo del mapa (primer componente)
     for (int p = 0; p < PATTERN_MAP_SIZE; p++) {
         if (pattern_changed[p] > pattern_unchanged[p]) {
-            pattern_map |= (1 << p);
+            pattern_map |= (1 << (3 - p));
         }
     }
 
-    size_t pattern_map_offset = *offset;
-    uint8_t pattern_map_to_embed = pattern_map << 4; 
-    if (lsb1_embed(bmp, &pattern_map_to_embed, PATTERN_MAP_SIZE, &pattern_map_offset) != 0) {
+    return pattern_map;
+}
+
+int lsbi_embed_with_map(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset, uint8_t pattern_map) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
         return -1;
     }
 
-    component_index = *offset + PATTERN_MAP_SIZE;
-    bit_to_embed_count = 0;
-    for (; component_index < max_component_index && bit_to_embed_count < num_bits; component_index++) {
-        Component comp = get_component_by_index(bmp, component_index);
-        if (comp.component_ptr == NULL || (comp.color != GREEN && comp.color != BLUE)) {
-            continue;
-        }
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_count = 0;
+
+    if (gb_cursor_init(&cursor, bmp, *offset, num_bits) != 0) {
+        return -1;
+    }
+
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        size_t color = span.component % 3;
+        size_t i = 0;
 
-        uint8_t pattern = (*comp.component_ptr >> 1) & 0x03;
+        while (i < span.len) {
+            if (embed_blocks != NULL && bit_count % 8 == 0 && span.len - i >= LSBI_SIMD_BLOCK) {
+                size_t done = embed_blocks(span.ptr + i, span.len - i, (unsigned)color, data + bit_count / 8, pattern_map);
+                i += done;
+                bit_count += done / 3 * 2;
+                continue;
+            }
 
-        if ((pattern_map & (1 << pattern)) && ((*comp.component_ptr & 0x01) != ((data[bit_to_embed_count / 8] >> (7 - (bit_to_embed_count % 8))) & 0x01))) {
-            *comp.component_ptr ^= 0x01;
+            if (color != RED) {
+                uint8_t pattern = (span.ptr[i] >> 1) & 0x03;
+                uint8_t bit = data_bit(data, bit_count);
+
+                // Los patrones marcados en el mapa guardan el bit invertido
+                if ((pattern_map & (1 << (3 - pattern))) != 0) {
+                    bit ^= 0x01;
+                }
+
+                span.ptr[i] = (span.ptr[i] & 0xFE) | bit;
+                bit_count++;
+            }
+
+            if (++color == 3) {
+                color = 0;
+            }
+            i++;
         }
+    }
+
+    *offset = cursor.next;
+    return 0;
+}
+
+int lsbi_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL) {
+        return -1;
+    }
+
+    size_t pattern_changed[PATTERN_MAP_SIZE] = {0};
+    size_t pattern_unchanged[PATTERN_MAP_SIZE] = {0};
+    size_t component_index = *offset + PATTERN_MAP_SIZE;
+
+    if (lsbi_histogram(bmp, data, num_bits, &component_index, pattern_changed, pattern_unchanged) != 0) {
+        return -1;
+    }
 
-        bit_to_embed_count++;
+    uint8_t pattern_map = lsbi_pattern_map(pattern_changed, pattern_unchanged);
+
+    size_t pattern_map_offset = *offset;
+    uint8_t pattern_map_to_embed = pattern_map << 4; 
+    if (lsb1_embed(bmp, &pattern_map_to_embed, PATTERN_MAP_SIZE, &pattern_map_offset) != 0) {
+        return -1;
+    }
+
+    component_index = *offset + PATTERN_MAP_SIZE;
+    if (lsbi_embed_with_map(bmp, data, num_bits, &component_index, pattern_map) != 0) {
+        return -1;
     }
 
     *offset = component_index;
@@ -86,34 +251,64 @@ int lsbi_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *
 
     memset(buffer, 0, (num_bits + 7) / 8);
 
-    size_t max_component_index = bmp->width * bmp->height * 3; 
-    size_t component_index = *offset;
+    BMPSpanCursor cursor;
+    BMPSpan span;
     size_t bit_extracted_count = 0;
     uint8_t pattern_map = *((uint8_t *)context) >> 4; 
+    const uint8_t *table = recovered_bit[pattern_map & 0x0F];
 
-    for (; component_index < max_component_index && bit_extracted_count < num_bits; component_index++) {
+    if (gb_cursor_init(&cursor, bmp, *offset, num_bits) != 0) {
+        return -1;
+    }
 
-        Component comp = get_component_by_index(bmp, component_index);
-        if (comp.component_ptr == NULL || (comp.color != GREEN && comp.color != BLUE)) {
-            continue; 
-        }
-        
-        uint8_t component = *comp.component_ptr;
-        uint8_t pattern = (component >> 1) & 0x03; 
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        size_t color = span.component % 3;
+        size_t i = 0;
 
-        if ((pattern_map & (1 << (3 - pattern))) != 0) { 
-            component ^= 0x01;  
+        while (i < span.len) {
+            // Alineado a byte: bloques vectoriales y luego bytes de a 12 componentes
+            if (bit_extracted_count % 8 == 0 && span.len - i >= 12) {
+                size_t done = 0;
+
+                if (extract_blocks != NULL && span.len - i >= LSBI_SIMD_BLOCK) {
+                    done = extract_blocks(span.ptr + i, span.len - i, (unsigned)color,
+                                          buffer + bit_extracted_count / 8, pattern_map);
+                }
+                done += extract_bytes(span.ptr + i + done, span.len - i - done, (unsigned)color,
+                                      buffer + bit_extracted_count / 8 + done / 12, table);
+
+                i += done;
+                bit_extracted_count += done / 3 * 2;
+                continue;
+            }
+
+            if (color != RED) {
+                buffer[bit_extracted_count / 8] |= (uint8_t)(table[span.ptr[i]] << (7 - (bit_extracted_count % 8)));
+                bit_extracted_count++;
+            }
+
+            if (++color == 3) {
+                color = 0;
+            }
+            i++;
         }
+    }
+
+    *offset = cursor.next;
+    return 0;
+}
 
-        uint8_t bit = component & 0x01;
-        buffer[bit_extracted_count / 8] |= (bit << (7 - (bit_extracted_count % 8)));
-        bit_extracted_count++;
+size_t lsbi_capacity_bits(const BMPImage *bmp, size_t offset) {
+    if (bmp == NULL) {
+        return 0;
     }
 
-    if (bit_extracted_count != num_bits) {
-        return -1;
+    size_t max_component_index = bmp->width * bmp->height * 3;
+    if (offset >= max_component_index) {
+        return 0;
     }
 
-    *offset = component_index;
-    return 0;
+    // El color solo depende de index % 3 (cada fila tiene width * 3 componentes):
+    // en [0, n) hay n / 3 componentes rojos
+    return (max_component_index - max_component_index / 3) - (offset - offset / 3);
 }
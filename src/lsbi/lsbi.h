@@ -7,12 +7,56 @@
 
 #define PATTERN_MAP_SIZE 4
 
+/**
+ * @brief Counts, per 2nd/3rd LSB pattern, how many components plain LSB would change
+ * 
+ * Read-only pass over the Green and Blue components starting at *offset. Counts are
+ * accumulated into the given arrays, so consecutive calls over consecutive chunks of
+ * the payload produce the same histogram as a single call.
+ * 
+ * @param bmp Pointer to BMPImage structure holding the carrier
+ * @param data Pointer to data that will be embedded
+ * @param num_bits Number of bits to account for
+ * @param offset Pointer to the starting component index (updated past the last component used)
+ * @param pattern_changed Per-pattern count of components whose LSB differs from the data bit
+ * @param pattern_unchanged Per-pattern count of components whose LSB already matches
+ * 
+ * @return 0 on success, -1 if the carrier runs out of components
+ */
+int lsbi_histogram(const BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset,
+                   size_t pattern_changed[PATTERN_MAP_SIZE], size_t pattern_unchanged[PATTERN_MAP_SIZE]);
+
+/**
+ * @brief Builds the 4-bit pattern inversion map from a histogram
+ * 
+ * Bit (3 - p) is set when pattern p changes more components than it keeps, matching
+ * the order in which the map is stored in the first 4 components (pattern 00 first).
+ * 
+ * @return The pattern map in the low 4 bits
+ */
+uint8_t lsbi_pattern_map(const size_t pattern_changed[PATTERN_MAP_SIZE], const size_t pattern_unchanged[PATTERN_MAP_SIZE]);
+
+/**
+ * @brief Writes data bits into Green and Blue LSBs, inverting the patterns set in the map
+ * 
+ * Single write pass; the pattern map itself is not stored by this function.
+ * 
+ * @param bmp Pointer to BMPImage structure where data will be embedded
+ * @param data Pointer to data to embed
+ * @param num_bits Number of bits to embed
+ * @param offset Pointer to the starting component index (updated past the last component used)
+ * @param pattern_map Pattern map as returned by lsbi_pattern_map()
+ * 
+ * @return 0 on success, -1 if the carrier runs out of components
+ */
+int lsbi_embed_with_map(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offset, uint8_t pattern_map);
+
 /**
  * @brief Embeds data into BMP pixels using LSBI (LSB with bit inversion)
  * 
  * LSBI Algorithm (from paper):
  * 1. Uses only Green and Blue channels (Red acts as noise for security)
- * 2. Applies standard LSB first
+ * 2. Counts the changes standard LSB would make (read-only histogram pass)
  * 3. Classifies pixels by 2nd and 3rd LSB patterns (00, 01, 10, 11)
  * 4. Inverts LSB if more pixels changed than unchanged in each pattern
  * 5. Stores pattern inversion map in first 4 components using LSB1 (all components)
@@ -50,4 +94,14 @@ int lsbi_embed(BMPImage *bmp, const uint8_t *data, size_t num_bits, size_t *offs
  */
 int lsbi_extract(const BMPImage *bmp, size_t num_bits, uint8_t *buffer, size_t *offset, void *context);
 
+/**
+ * @brief Number of data bits LSBI can hold from a component index to the end of the image
+ * 
+ * @param bmp Pointer to BMPImage structure
+ * @param offset Component index where the data starts (after the pattern map)
+ * 
+ * @return Number of Green and Blue components in [offset, width * height * 3)
+ */
+size_t lsbi_capacity_bits(const BMPImage *bmp, size_t offset);
+
 #endif // LSBI_H
\ No newline at end of file
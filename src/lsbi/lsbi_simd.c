@@ -0,0 +1,309 @@
+#include "lsbi_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include <string.h>
+
+#define LSBI_SIMD_SPAN (2 * LSBI_SIMD_BLOCK)
+
+/*
+ * Tablas por fase (color del primer componente) para 96 componentes:
+ * - lane_byte: byte de payload (0..7) del bit de cada carril, 0x80 en rojos (pshufb deja 0)
+ * - lane_bit: máscara del bit dentro de ese byte (0 en rojos)
+ * - lane_gb: 0x01 en carriles verde/azul, 0 en rojos
+ * Con AVX2 los 8 bytes de payload se replican en los dos carriles de 128 bits,
+ * así que los índices 0..7 sirven igual para pshufb de 128 y de 256 bits.
+ */
+static uint8_t lane_byte[3][LSBI_SIMD_SPAN];
+static uint8_t lane_bit[3][LSBI_SIMD_SPAN];
+static uint8_t lane_gb[3][LSBI_SIMD_SPAN];
+
+/*
+ * Extract: índices de pshufb que juntan los 32 carriles verde/azul de un bloque
+ * (3 vectores de origen) en 2 vectores de salida. Dentro de cada grupo de 8 el
+ * orden se invierte para que pmovmskb deje el primer bit en el MSB del byte.
+ */
+static uint8_t gather_index[3][2][3][16];
+
+__attribute__((constructor))
+static void build_tables(void) {
+    for (unsigned phase = 0; phase < 3; phase++) {
+        size_t g = 0;
+
+        for (size_t j = 0; j < LSBI_SIMD_SPAN; j++) {
+            if ((phase + j) % 3 == 2) {
+                lane_byte[phase][j] = 0x80;
+                lane_bit[phase][j] = 0;
+                lane_gb[phase][j] = 0;
+                continue;
+            }
+
+            lane_byte[phase][j] = (uint8_t)(g / 8);
+            lane_bit[phase][j] = (uint8_t)(0x80 >> (g % 8));
+            lane_gb[phase][j] = 1;
+            g++;
+        }
+    }
+
+    memset(gather_index, 0x80, sizeof(gather_index));
+
+    for (unsigned phase = 0; phase < 3; phase++) {
+        size_t g = 0;
+
+        for (size_t j = 0; j < LSBI_SIMD_BLOCK; j++) {
+            if ((phase + j) % 3 == 2) {
+                continue;
+            }
+
+            size_t lane = g % 16;
+            gather_index[phase][g / 16][j / 16][(lane / 8) * 8 + 7 - lane % 8] = (uint8_t)(j % 16);
+            g++;
+        }
+    }
+}
+
+// Carril p (0..3) = 1 si el patrón p se guarda invertido (bit 3 - p del mapa)
+static inline uint32_t invert_lanes(uint8_t pattern_map) {
+    return (uint32_t)((pattern_map >> 3) & 1) | (uint32_t)((pattern_map >> 2) & 1) << 8 |
+           (uint32_t)((pattern_map >> 1) & 1) << 16 | (uint32_t)(pattern_map & 1) << 24;
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i payload_bits_ssse3(__m128i payload, const uint8_t *byte, const uint8_t *bit) {
+    __m128i select = _mm_loadu_si128((const __m128i *)bit);
+    __m128i spread = _mm_and_si128(_mm_shuffle_epi8(payload, _mm_loadu_si128((const __m128i *)byte)), select);
+    return _mm_and_si128(_mm_cmpeq_epi8(spread, select), _mm_set1_epi8(0x01));
+}
+
+/*
+ * El histograma se acumula en contadores de 8 bits por carril (restar la
+ * máscara de cmpeq suma 1) y se vuelca con psadbw antes de que desborden:
+ * cada bloque suma a lo sumo LSBI_SIMD_BLOCK / 16 por carril.
+ */
+#define LSBI_FLUSH_BLOCKS 80
+
+__attribute__((target("ssse3")))
+static inline size_t sum_lanes_ssse3(__m128i acc) {
+    __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+    return (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+}
+
+__attribute__((target("ssse3")))
+static inline void flush_ssse3(__m128i total[4], __m128i flips[4], size_t pattern_changed[4], size_t pattern_unchanged[4]) {
+    for (int p = 0; p < 4; p++) {
+        size_t t = sum_lanes_ssse3(total[p]);
+        size_t f = sum_lanes_ssse3(flips[p]);
+        pattern_changed[p] += f;
+        pattern_unchanged[p] += t - f;
+        total[p] = _mm_setzero_si128();
+        flips[p] = _mm_setzero_si128();
+    }
+}
+
+__attribute__((target("ssse3")))
+size_t lsbi_histogram_blocks_ssse3(const uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data,
+                                   size_t pattern_changed[4], size_t pattern_unchanged[4]) {
+    const __m128i three = _mm_set1_epi8(0x03);
+    const __m128i one = _mm_set1_epi8(0x01);
+    __m128i total[4], flips[4];
+    size_t done = 0;
+    unsigned pending = 0;
+
+    for (int p = 0; p < 4; p++) {
+        total[p] = _mm_setzero_si128();
+        flips[p] = _mm_setzero_si128();
+    }
+
+    for (; len - done >= LSBI_SIMD_BLOCK; done += LSBI_SIMD_BLOCK, data += 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        __m128i payload = _mm_cvtsi32_si128((int)word);
+
+        for (size_t k = 0; k < LSBI_SIMD_BLOCK; k += 16) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(ptr + done + k));
+            __m128i gb = _mm_loadu_si128((const __m128i *)&lane_gb[phase][k]);
+            __m128i bits = payload_bits_ssse3(payload, &lane_byte[phase][k], &lane_bit[phase][k]);
+
+            __m128i pattern = _mm_and_si128(_mm_srli_epi16(c, 1), three);
+            __m128i is_gb = _mm_cmpeq_epi8(gb, one);
+            __m128i changed = _mm_cmpeq_epi8(_mm_and_si128(_mm_xor_si128(c, bits), gb), one);
+
+            for (int p = 0; p < 4; p++) {
+                __m128i in_pattern = _mm_and_si128(_mm_cmpeq_epi8(pattern, _mm_set1_epi8((char)p)), is_gb);
+                total[p] = _mm_sub_epi8(total[p], in_pattern);
+                flips[p] = _mm_sub_epi8(flips[p], _mm_and_si128(in_pattern, changed));
+            }
+        }
+
+        if (++pending == LSBI_FLUSH_BLOCKS) {
+            flush_ssse3(total, flips, pattern_changed, pattern_unchanged);
+            pending = 0;
+        }
+    }
+
+    flush_ssse3(total, flips, pattern_changed, pattern_unchanged);
+    return done;
+}
+
+__attribute__((target("ssse3")))
+size_t lsbi_embed_blocks_ssse3(uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data, uint8_t pattern_map) {
+    const __m128i three = _mm_set1_epi8(0x03);
+    const __m128i invert = _mm_cvtsi32_si128((int)invert_lanes(pattern_map));
+    size_t done = 0;
+
+    for (; len - done >= LSBI_SIMD_BLOCK; done += LSBI_SIMD_BLOCK, data += 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        __m128i payload = _mm_cvtsi32_si128((int)word);
+
+        for (size_t k = 0; k < LSBI_SIMD_BLOCK; k += 16) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(ptr + done + k));
+            __m128i gb = _mm_loadu_si128((const __m128i *)&lane_gb[phase][k]);
+            __m128i bits = payload_bits_ssse3(payload, &lane_byte[phase][k], &lane_bit[phase][k]);
+
+            // Bit a guardar: el del payload, invertido si el patrón del componente está marcado
+            __m128i pattern = _mm_and_si128(_mm_srli_epi16(c, 1), three);
+            bits = _mm_xor_si128(bits, _mm_shuffle_epi8(invert, pattern));
+
+            // Solo cambia el LSB de los carriles verde/azul
+            __m128i out = _mm_xor_si128(c, _mm_and_si128(_mm_xor_si128(c, bits), gb));
+            _mm_storeu_si128((__m128i *)(ptr + done + k), out);
+        }
+    }
+
+    return done;
+}
+
+__attribute__((target("ssse3")))
+size_t lsbi_extract_blocks_ssse3(const uint8_t *ptr, size_t len, unsigned phase, uint8_t *out, uint8_t pattern_map) {
+    const __m128i three = _mm_set1_epi8(0x03);
+    const __m128i one = _mm_set1_epi8(0x01);
+    const __m128i invert = _mm_cvtsi32_si128((int)invert_lanes(pattern_map));
+    size_t done = 0;
+
+    for (; len - done >= LSBI_SIMD_BLOCK; done += LSBI_SIMD_BLOCK, out += 4) {
+        __m128i recovered[3];
+
+        // Bit recuperado de cada componente: su LSB, invertido si el patrón está marcado
+        for (int k = 0; k < 3; k++) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(ptr + done + 16 * k));
+            __m128i pattern = _mm_and_si128(_mm_srli_epi16(c, 1), three);
+            recovered[k] = _mm_xor_si128(_mm_and_si128(c, one), _mm_shuffle_epi8(invert, pattern));
+        }
+
+        for (int o = 0; o < 2; o++) {
+            __m128i bits = _mm_setzero_si128();
+
+            for (int k = 0; k < 3; k++) {
+                __m128i index = _mm_loadu_si128((const __m128i *)gather_index[phase][o][k]);
+                bits = _mm_or_si128(bits, _mm_shuffle_epi8(recovered[k], index));
+            }
+
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_slli_epi16(bits, 7));
+            out[2 * o] = (uint8_t)mask;
+            out[2 * o + 1] = (uint8_t)(mask >> 8);
+        }
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i payload_bits_avx2(__m256i payload, const uint8_t *byte, const uint8_t *bit) {
+    __m256i select = _mm256_loadu_si256((const __m256i *)bit);
+    __m256i spread = _mm256_and_si256(_mm256_shuffle_epi8(payload, _mm256_loadu_si256((const __m256i *)byte)), select);
+    return _mm256_and_si256(_mm256_cmpeq_epi8(spread, select), _mm256_set1_epi8(0x01));
+}
+
+__attribute__((target("avx2")))
+static inline size_t sum_lanes_avx2(__m256i acc) {
+    __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    return (size_t)_mm256_extract_epi64(sums, 0) + (size_t)_mm256_extract_epi64(sums, 1) +
+           (size_t)_mm256_extract_epi64(sums, 2) + (size_t)_mm256_extract_epi64(sums, 3);
+}
+
+__attribute__((target("avx2")))
+static inline void flush_avx2(__m256i total[4], __m256i flips[4], size_t pattern_changed[4], size_t pattern_unchanged[4]) {
+    for (int p = 0; p < 4; p++) {
+        size_t t = sum_lanes_avx2(total[p]);
+        size_t f = sum_lanes_avx2(flips[p]);
+        pattern_changed[p] += f;
+        pattern_unchanged[p] += t - f;
+        total[p] = _mm256_setzero_si256();
+        flips[p] = _mm256_setzero_si256();
+    }
+}
+
+__attribute__((target("avx2")))
+size_t lsbi_histogram_blocks_avx2(const uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data,
+                                  size_t pattern_changed[4], size_t pattern_unchanged[4]) {
+    const __m256i three = _mm256_set1_epi8(0x03);
+    const __m256i one = _mm256_set1_epi8(0x01);
+    __m256i total[4], flips[4];
+    size_t done = 0;
+    unsigned pending = 0;
+
+    for (int p = 0; p < 4; p++) {
+        total[p] = _mm256_setzero_si256();
+        flips[p] = _mm256_setzero_si256();
+    }
+
+    for (; len - done >= LSBI_SIMD_SPAN; done += LSBI_SIMD_SPAN, data += 8) {
+        int64_t word;
+        memcpy(&word, data, sizeof(word));
+        __m256i payload = _mm256_set1_epi64x(word);
+
+        for (size_t k = 0; k < LSBI_SIMD_SPAN; k += 32) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)(ptr + done + k));
+            __m256i gb = _mm256_loadu_si256((const __m256i *)&lane_gb[phase][k]);
+            __m256i bits = payload_bits_avx2(payload, &lane_byte[phase][k], &lane_bit[phase][k]);
+
+            __m256i pattern = _mm256_and_si256(_mm256_srli_epi16(c, 1), three);
+            __m256i is_gb = _mm256_cmpeq_epi8(gb, one);
+            __m256i changed = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_xor_si256(c, bits), gb), one);
+
+            for (int p = 0; p < 4; p++) {
+                __m256i in_pattern = _mm256_and_si256(_mm256_cmpeq_epi8(pattern, _mm256_set1_epi8((char)p)), is_gb);
+                total[p] = _mm256_sub_epi8(total[p], in_pattern);
+                flips[p] = _mm256_sub_epi8(flips[p], _mm256_and_si256(in_pattern, changed));
+            }
+        }
+
+        if (++pending == LSBI_FLUSH_BLOCKS) {
+            flush_avx2(total, flips, pattern_changed, pattern_unchanged);
+            pending = 0;
+        }
+    }
+
+    flush_avx2(total, flips, pattern_changed, pattern_unchanged);
+    return done + lsbi_histogram_blocks_ssse3(ptr + done, len - done, phase, data, pattern_changed, pattern_unchanged);
+}
+
+__attribute__((target("avx2")))
+size_t lsbi_embed_blocks_avx2(uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data, uint8_t pattern_map) {
+    const __m256i three = _mm256_set1_epi8(0x03);
+    const __m256i invert = _mm256_set1_epi32((int)invert_lanes(pattern_map));
+    size_t done = 0;
+
+    for (; len - done >= LSBI_SIMD_SPAN; done += LSBI_SIMD_SPAN, data += 8) {
+        int64_t word;
+        memcpy(&word, data, sizeof(word));
+        __m256i payload = _mm256_set1_epi64x(word);
+
+        for (size_t k = 0; k < LSBI_SIMD_SPAN; k += 32) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)(ptr + done + k));
+            __m256i gb = _mm256_loadu_si256((const __m256i *)&lane_gb[phase][k]);
+            __m256i bits = payload_bits_avx2(payload, &lane_byte[phase][k], &lane_bit[phase][k]);
+
+            __m256i pattern = _mm256_and_si256(_mm256_srli_epi16(c, 1), three);
+            bits = _mm256_xor_si256(bits, _mm256_shuffle_epi8(invert, pattern));
+
+            __m256i out = _mm256_xor_si256(c, _mm256_and_si256(_mm256_xor_si256(c, bits), gb));
+            _mm256_storeu_si256((__m256i *)(ptr + done + k), out);
+        }
+    }
+
+    return done + lsbi_embed_blocks_ssse3(ptr + done, len - done, phase, data, pattern_map);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef LSBI_SIMD_H
+#define LSBI_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file lsbi_simd.h
+ * @brief Block kernels for the LSBI histogram and embedding passes
+ * 
+ * A block is a run of LSBI_SIMD_BLOCK contiguous components inside one row:
+ * any such run holds exactly 2/3 of its length in Green/Blue components, so
+ * whole payload bytes map onto whole blocks whatever the colour of the first
+ * component. Payload bits are spread onto the G/B lanes with a shuffle and red
+ * lanes are masked out, so the carrier is processed in place without gathering.
+ * 
+ * Kernels process as many whole blocks as fit in len and return the number of
+ * components consumed (a multiple of their block size). data must point at the
+ * payload byte holding the first bit, which must be byte aligned.
+ */
+
+/** Components per block: 16 pixels, 32 G/B components, 4 payload bytes */
+#define LSBI_SIMD_BLOCK 48
+
+/** Accumulates the per-pattern histogram over whole blocks (see lsbi_histogram()) */
+typedef size_t (*lsbi_histogram_blocks_fn)(const uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data,
+                                           size_t pattern_changed[4], size_t pattern_unchanged[4]);
+
+/** Embeds whole blocks with the given pattern map (see lsbi_embed_with_map()) */
+typedef size_t (*lsbi_embed_blocks_fn)(uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data, uint8_t pattern_map);
+
+/** Extracts whole blocks into out (4 bytes per block) with the given pattern map (see lsbi_extract()) */
+typedef size_t (*lsbi_extract_blocks_fn)(const uint8_t *ptr, size_t len, unsigned phase, uint8_t *out, uint8_t pattern_map);
+
+#if defined(__x86_64__) || defined(__i386__)
+/** SSSE3 kernels: one 48-component block per step */
+size_t lsbi_histogram_blocks_ssse3(const uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data,
+                                   size_t pattern_changed[4], size_t pattern_unchanged[4]);
+size_t lsbi_embed_blocks_ssse3(uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data, uint8_t pattern_map);
+size_t lsbi_extract_blocks_ssse3(const uint8_t *ptr, size_t len, unsigned phase, uint8_t *out, uint8_t pattern_map);
+
+/** AVX2 kernels: two blocks (96 components, 8 payload bytes) per step */
+size_t lsbi_histogram_blocks_avx2(const uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data,
+                                  size_t pattern_changed[4], size_t pattern_unchanged[4]);
+size_t lsbi_embed_blocks_avx2(uint8_t *ptr, size_t len, unsigned phase, const uint8_t *data, uint8_t pattern_map);
+#endif
+
+#endif // LSBI_SIMD_H
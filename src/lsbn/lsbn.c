@@ -0,0 +1,263 @@
+#include "lsbn.h"
+#include "../lsb1/lsb1.h"
+#include "../lsb4/lsb4.h"
+#include "../common/bmp_image.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Un grupo es la menor cantidad de componentes que guarda un número entero de
+ * bytes: mcm(n, 8) / n componentes para mcm(n, 8) / 8 bytes. Los kernels de
+ * grupo se generan por macro para cada n, con desplazamientos y máscaras
+ * constantes. Para n = 1 y n = 4 se usan los kernels vectoriales de LSB1/LSB4.
+ * Lo que no completa un grupo (inicio desalineado, fin de fila, fin del
+ * payload) se escribe de a un componente.
+ */
+
+#define LSBN_MASK(n) ((1u << (n)) - 1)
+
+typedef void (*lsbn_embed_groups_fn)(uint8_t *dst, const uint8_t *src, size_t groups);
+typedef void (*lsbn_extract_groups_fn)(const uint8_t *src, uint8_t *dst, size_t groups);
+
+typedef struct {
+    size_t components;              // Componentes por grupo
+    size_t bytes;                   // Bytes de payload por grupo
+    lsbn_embed_groups_fn embed;
+    lsbn_extract_groups_fn extract;
+} lsbn_kernel_t;
+
+#define LSBN_GROUP_KERNELS(N, COMPONENTS, BYTES)                                                       \
+    static void embed_groups_##N(uint8_t *dst, const uint8_t *src, size_t groups) {                  \
+        for (size_t g = 0; g < groups; g++, dst += (COMPONENTS), src += (BYTES)) {                   \
+            uint64_t v = 0;                                                                          \
+            for (int b = 0; b < (BYTES); b++) {                                                      \
+                v = (v << 8) | src[b];                                                               \
+            }                                                                                        \
+            for (int k = 0; k < (COMPONENTS); k++) {                                                 \
+                unsigned bits = (unsigned)(v >> (((COMPONENTS) - 1 - k) * (N))) & LSBN_MASK(N);      \
+                dst[k] = (uint8_t)((dst[k] & ~LSBN_MASK(N)) | bits);                                 \
+            }                                                                                        \
+        }                                                                                            \
+    }                                                                                                \
+    static void extract_groups_##N(const uint8_t *src, uint8_t *dst, size_t groups) {                \
+        for (size_t g = 0; g < groups; g++, src += (COMPONENTS), dst += (BYTES)) {                   \
+            uint64_t v = 0;                                                                          \
+            for (int k = 0; k < (COMPONENTS); k++) {                                                 \
+                v = (v << (N)) | (src[k] & LSBN_MASK(N));                                            \
+            }                                                                                        \
+            for (int b = 0; b < (BYTES); b++) {                                                      \
+                dst[b] = (uint8_t)(v >> (((BYTES) - 1 - b) * 8));                                    \
+            }                                                                                        \
+        }                                                                                            \
+    }
+
+LSBN_GROUP_KERNELS(1, 8, 1)
+LSBN_GROUP_KERNELS(2, 4, 1)
+LSBN_GROUP_KERNELS(3, 8, 3)
+LSBN_GROUP_KERNELS(4, 2, 1)
+LSBN_GROUP_KERNELS(5, 8, 5)
+LSBN_GROUP_KERNELS(6, 4, 3)
+LSBN_GROUP_KERNELS(7, 8, 7)
+LSBN_GROUP_KERNELS(8, 1, 1)
+
+#define LSBN_KERNEL(N, COMPONENTS, BYTES) { (COMPONENTS), (BYTES), embed_groups_##N, extract_groups_##N }
+
+static const lsbn_kernel_t kernels[LSBN_MAX_BITS + 1] = {
+    [1] = LSBN_KERNEL(1, 8, 1),
+    [2] = LSBN_KERNEL(2, 4, 1),
+    [3] = LSBN_KERNEL(3, 8, 3),
+    [4] = LSBN_KERNEL(4, 2, 1),
+    [5] = LSBN_KERNEL(5, 8, 5),
+    [6] = LSBN_KERNEL(6, 4, 3),
+    [7] = LSBN_KERNEL(7, 8, 7),
+    [8] = LSBN_KERNEL(8, 1, 1),
+};
+
+// Lee count bits (count <= 8) de data a partir del bit bit_index, el primero como más significativo
+static inline unsigned read_bits(const uint8_t *data, size_t bit_index, unsigned count) {
+    unsigned shift = (unsigned)(bit_index % 8);
+    unsigned v = (unsigned)data[bit_index / 8] << 8;
+
+    if (shift + count > 8) {
+        v |= data[bit_index / 8 + 1];
+    }
+    return (v >> (16 - shift - count)) & LSBN_MASK(count);
+}
+
+// Agrega count bits a buffer (ya en cero) a partir del bit bit_index
+static inline void write_bits(uint8_t *buffer, size_t bit_index, unsigned count, unsigned value) {
+    unsigned shift = (unsigned)(bit_index % 8);
+    unsigned v = value << (16 - shift - count);
+
+    buffer[bit_index / 8] |= (uint8_t)(v >> 8);
+    if (shift + count > 8) {
+        buffer[bit_index / 8 + 1] |= (uint8_t)v;
+    }
+}
+
+// Oculta bits [*bit_index, end_bit) de data en len componentes contiguos
+static void embed_span(const lsbn_kernel_t *k, unsigned n, uint8_t *dst, size_t len,
+                       const uint8_t *data, size_t *bit_index, size_t end_bit, unsigned *carry) {
+    size_t i = 0;
+
+    while (i < len && *bit_index < end_bit) {
+        if (*carry == 0 && *bit_index % 8 == 0) {
+            size_t groups = (len - i) / k->components;
+            size_t data_groups = (end_bit - *bit_index) / (k->bytes * 8);
+
+            if (groups > data_groups) {
+                groups = data_groups;
+            }
+            if (groups > 0) {
+                k->embed(dst + i, data + *bit_index / 8, groups);
+                i += groups * k->components;
+                *bit_index += groups * k->bytes * 8;
+                continue;
+            }
+        }
+
+        // Un componente: los bits libres que quedan, o lo que falta del payload
+        unsigned count = n - *carry;
+        if (count > end_bit - *bit_index) {
+            count = (unsigned)(end_bit - *bit_index);
+        }
+
+        unsigned shift = n - *carry - count;
+        unsigned mask = LSBN_MASK(count) << shift;
+        dst[i] = (uint8_t)((dst[i] & ~mask) | (read_bits(data, *bit_index, count) << shift));
+
+        *bit_index += count;
+        *carry += count;
+        if (*carry == n) {
+            *carry = 0;
+            i++;
+        }
+    }
+}
+
+// Extrae bits [*bit_index, end_bit) de len componentes contiguos hacia buffer
+static void extract_span(const lsbn_kernel_t *k, unsigned n, const uint8_t *src, size_t len,
+                         uint8_t *buffer, size_t *bit_index, size_t end_bit, unsigned *carry) {
+    size_t i = 0;
+
+    while (i < len && *bit_index < end_bit) {
+        if (*carry == 0 && *bit_index % 8 == 0) {
+            size_t groups = (len - i) / k->components;
+            size_t data_groups = (end_bit - *bit_index) / (k->bytes * 8);
+
+            if (groups > data_groups) {
+                groups = data_groups;
+            }
+            if (groups > 0) {
+                k->extract(src + i, buffer + *bit_index / 8, groups);
+                i += groups * k->components;
+                *bit_index += groups * k->bytes * 8;
+                continue;
+            }
+        }
+
+        unsigned count = n - *carry;
+        if (count > end_bit - *bit_index) {
+            count = (unsigned)(end_bit - *bit_index);
+        }
+
+        unsigned shift = n - *carry - count;
+        write_bits(buffer, *bit_index, count, (src[i] >> shift) & LSBN_MASK(count));
+
+        *bit_index += count;
+        *carry += count;
+        if (*carry == n) {
+            *carry = 0;
+            i++;
+        }
+    }
+}
+
+int lsbn_embed(BMPImage *bmp, unsigned n, const uint8_t *data, size_t num_bits, size_t *offset, unsigned *carry) {
+    if (bmp == NULL || bmp->data == NULL || data == NULL || offset == NULL || carry == NULL) {
+        return -1;
+    }
+
+    if (n == 0 || n > LSBN_MAX_BITS || *carry >= n) {
+        return -1;
+    }
+
+    // Caminos rápidos: sin componente compartido, LSB1/LSB4 tienen kernels vectoriales
+    if (n == 1) {
+        return lsb1_embed(bmp, data, num_bits, offset);
+    }
+    if (n == 4 && *carry == 0 && num_bits % 4 == 0) {
+        return lsb4_embed(bmp, data, num_bits, offset);
+    }
+
+    if (lsbn_capacity_bits(bmp, n, *offset, *carry) < num_bits) {
+        return -1;
+    }
+
+    size_t used = *carry + num_bits;
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_index = 0;
+    unsigned slot = *carry;
+
+    bmp_span_cursor_init(&cursor, bmp, *offset, (used + n - 1) / n);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        embed_span(&kernels[n], n, span.ptr, span.len, data, &bit_index, num_bits, &slot);
+    }
+
+    *offset += used / n;
+    *carry = (unsigned)(used % n);
+    return 0;
+}
+
+int lsbn_extract(const BMPImage *bmp, unsigned n, size_t num_bits, uint8_t *buffer, size_t *offset, unsigned *carry) {
+    if (bmp == NULL || bmp->data == NULL || buffer == NULL || offset == NULL || carry == NULL) {
+        return -1;
+    }
+
+    if (n == 0 || n > LSBN_MAX_BITS || *carry >= n) {
+        return -1;
+    }
+
+    if (n == 1) {
+        return lsb1_extract(bmp, num_bits, buffer, offset);
+    }
+    if (n == 4 && *carry == 0 && num_bits % 4 == 0) {
+        return lsb4_extract(bmp, num_bits, buffer, offset);
+    }
+
+    memset(buffer, 0, (num_bits + 7) / 8);
+
+    if (lsbn_capacity_bits(bmp, n, *offset, *carry) < num_bits) {
+        return -1;
+    }
+
+    size_t used = *carry + num_bits;
+    BMPSpanCursor cursor;
+    BMPSpan span;
+    size_t bit_index = 0;
+    unsigned slot = *carry;
+
+    bmp_span_cursor_init(&cursor, bmp, *offset, (used + n - 1) / n);
+    while (bmp_span_next(&cursor, SIZE_MAX, &span)) {
+        extract_span(&kernels[n], n, span.ptr, span.len, buffer, &bit_index, num_bits, &slot);
+    }
+
+    *offset += used / n;
+    *carry = (unsigned)(used % n);
+    return 0;
+}
+
+size_t lsbn_capacity_bits(const BMPImage *bmp, unsigned n, size_t offset, unsigned carry) {
+    if (bmp == NULL || n == 0 || n > LSBN_MAX_BITS) {
+        return 0;
+    }
+
+    size_t max_component_index = bmp->width * bmp->height * 3;
+    if (offset >= max_component_index) {
+        return 0;
+    }
+
+    size_t bits = (max_component_index - offset) * n;
+    return bits > carry ? bits - carry : 0;
+}
@@ -0,0 +1,63 @@
+#ifndef LSBN_H
+#define LSBN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../common/bmp_image.h"
+
+/** Largest number of bits per component supported by LSBn */
+#define LSBN_MAX_BITS 8
+
+/**
+ * @brief Embeds data into the n least significant bits of each component (LSBn, n = 1..8)
+ *
+ * The payload is read as a bit stream, most significant bit first, and split
+ * into n-bit groups stored in consecutive components (the first bit of each
+ * group goes to bit n-1). LSB1 and LSB4 are the n = 1 and n = 4 cases.
+ * When n does not divide 8 a component can be shared by two calls: carry
+ * holds how many of its n bits are already used.
+ *
+ * @param bmp Pointer to the BMPImage structure where data will be embedded
+ * @param n Bits per component (1..8)
+ * @param data Pointer to the data to be embedded
+ * @param num_bits Number of bits to embed
+ * @param offset Pointer to the component index holding the next free bit (updated after embedding)
+ * @param carry Pointer to the bits already used in component *offset, 0..n-1 (updated after embedding)
+ *
+ * @return 0 on success, negative error code on failure
+ *
+ * @note The function modifies the pixel data in place
+ * @note Requires (carry + num_bits) / n components, rounded up, from offset
+ * @note Nothing is modified if the image cannot hold num_bits from offset
+ */
+int lsbn_embed(BMPImage *bmp, unsigned n, const uint8_t *data, size_t num_bits, size_t *offset, unsigned *carry);
+
+/**
+ * @brief Extracts data hidden with lsbn_embed()
+ *
+ * @param bmp Pointer to the BMPImage structure containing embedded data
+ * @param n Bits per component (1..8)
+ * @param num_bits Number of bits to extract
+ * @param buffer Pointer to the output buffer where extracted data will be stored
+ * @param offset Pointer to the component index holding the next bit (updated after extraction)
+ * @param carry Pointer to the bits already consumed from component *offset (updated after extraction)
+ *
+ * @return 0 on success, negative error code on failure
+ *
+ * @note The output buffer must be pre-allocated with (num_bits + 7) / 8 bytes
+ */
+int lsbn_extract(const BMPImage *bmp, unsigned n, size_t num_bits, uint8_t *buffer, size_t *offset, unsigned *carry);
+
+/**
+ * @brief Number of data bits LSBn can hold from a position to the end of the image
+ *
+ * @param bmp Pointer to BMPImage structure
+ * @param n Bits per component (1..8)
+ * @param offset Starting component index
+ * @param carry Bits already used in component offset
+ *
+ * @return n bits per component over [offset, width * height * 3), minus carry
+ */
+size_t lsbn_capacity_bits(const BMPImage *bmp, unsigned n, size_t offset, unsigned carry);
+
+#endif // LSBN_H
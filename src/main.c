@@ -5,6 +5,8 @@
 #include "./bmp_handler/bmp_handler.h"
 #include "./utils/parser/parser.h"
 #include "./utils/operations/operations.h"
+#include "./utils/batch/batch.h"
+#include "./utils/server/server.h"
 
 static int exit_code_from_ops_result(OperationsResult rc)
 {
@@ -23,35 +25,43 @@ int main(int argc, char **argv)
         fprintf(stderr, "  stegobmp -embed -in file -p carrier.bmp -out out.bmp -steg LSB1\n");
         fprintf(stderr, "  stegobmp -extract -p out.bmp -out recovered -steg LSB1\n");
         fprintf(stderr, "  stegobmp -embed -in file -p carrier.bmp -out out.bmp -steg LSB1 -a aes256 -m cbc -pass mypassword\n");
+        fprintf(stderr, "  stegobmp -embed -in file -p carrier.bmp -out out.bmp -steg LSB1 -band 8M\n");
+        fprintf(stderr, "  stegobmp -embed -in file -p carrier.bmp -steg LSB1 -inplace\n");
+        fprintf(stderr, "  stegobmp -info -p carrier.bmp\n");
+        fprintf(stderr, "  stegobmp -batch jobs.txt -threads 8\n");
+        fprintf(stderr, "  stegobmp -serve /tmp/stegobmp.sock -threads 8\n");
         free_config(&config);
         return 1;
     }
 
-    // Load BMP file
-    Bmp bmp;
-    if (bmp_read(config.carrier_file, &bmp) != 0)
+    if (config.operation == OP_BATCH)
     {
-        fprintf(stderr, "Error leyendo BMP (24bpp sin compresion requerido)\n");
+        // One process for the whole manifest; the exit code says whether every job succeeded
+        int failed = batch_run(&config);
         free_config(&config);
-        return 1;
+        return failed == 0 ? 0 : 1;
     }
-    OperationsResult rc = OPS_OK;
 
-    switch (config.operation)
+    if (config.operation == OP_SERVE)
     {
-    case OP_EMBED:
-        rc = perform_embed(&config, &bmp);
-        break;
-    case OP_EXTRACT:
-        rc = perform_extract(&config, &bmp);
-        break;
-    default:
-        fprintf(stderr, "not valid operation\n");
-        rc = OPS_INVALID_STEG_METHOD;
-        break;
+        // Warm process: requests arrive on the socket until SIGINT/SIGTERM
+        int result = server_run(&config);
+        free_config(&config);
+        return result == 0 ? 0 : 1;
     }
 
-    bmp_free(&bmp);
+    if (config.operation == OP_INFO)
+    {
+        // Header-only: capacity per method without loading the pixels
+        OperationsResult rc = perform_info(&config);
+        free_config(&config);
+        return exit_code_from_ops_result(rc);
+    }
+
+    OperationsResult rc = perform_operation(&config);
+    if (rc == OPS_INVALID_ARGUMENTS)
+        fprintf(stderr, "not valid operation\n");
+
     free_config(&config);
     return exit_code_from_ops_result(rc);
 }
\ No newline at end of file
@@ -0,0 +1,719 @@
+#include "steg_stream.h"
+#include "../lsb1/lsb1.h"
+#include "../lsbi/lsbi.h"
+#include "../lsbn/lsbn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// part identifica el tramo cuando el paso se reparte entre hilos (0 en un solo hilo)
+typedef int (*band_step_fn)(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                            size_t part, void *ctx);
+
+typedef struct {
+    const StegSegment *segments;
+    size_t segment_count;
+    unsigned lsb_bits;    // n de LSBn
+    uint8_t pattern_map;
+    // Histograma LSBI por tramo; se suman al armar el pattern map
+    size_t changed[STEG_PARALLEL_MAX_PARTS][PATTERN_MAP_SIZE];
+    size_t unchanged[STEG_PARALLEL_MAX_PARTS][PATTERN_MAP_SIZE];
+} embed_ctx_t;
+
+typedef int (*segment_kernel_fn)(BMPImage *win, const uint8_t *data, size_t num_bits, size_t *offset,
+                                 unsigned *carry, size_t part, embed_ctx_t *e);
+
+typedef struct {
+    uint8_t *buffer;
+    unsigned lsb_bits;    // n de LSBn
+    uint8_t pattern_map;  // tal como se lee del portador (mapa << 4)
+} extract_ctx_t;
+
+// Aplica el kernel a los bytes [first_byte, first_byte + num_bits / 8) del payload, partido en segmentos
+static int embed_segments(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset,
+                          unsigned *carry, size_t part, embed_ctx_t *e, segment_kernel_fn kernel) {
+    size_t pos = first_byte;
+    size_t left = num_bits / 8;
+
+    for (size_t i = 0; i < e->segment_count && left > 0; i++) {
+        const StegSegment *seg = &e->segments[i];
+
+        if (pos >= seg->length) {
+            pos -= seg->length;
+            continue;
+        }
+
+        size_t take = seg->length - pos < left ? seg->length - pos : left;
+        int rc = kernel(win, seg->data + pos, take * 8, offset, carry, part, e);
+        if (rc != 0) {
+            return rc;
+        }
+
+        left -= take;
+        pos = 0;
+    }
+
+    return left == 0 ? 0 : -1;
+}
+
+static int kernel_lsbn(BMPImage *win, const uint8_t *data, size_t num_bits, size_t *offset,
+                       unsigned *carry, size_t part, embed_ctx_t *e) {
+    (void)part;
+    return lsbn_embed(win, e->lsb_bits, data, num_bits, offset, carry);
+}
+
+static int kernel_lsbi(BMPImage *win, const uint8_t *data, size_t num_bits, size_t *offset,
+                       unsigned *carry, size_t part, embed_ctx_t *e) {
+    (void)carry;
+    (void)part;
+    return lsbi_embed_with_map(win, data, num_bits, offset, e->pattern_map);
+}
+
+static int kernel_lsbi_histogram(BMPImage *win, const uint8_t *data, size_t num_bits, size_t *offset,
+                                 unsigned *carry, size_t part, embed_ctx_t *e) {
+    (void)carry;
+    return lsbi_histogram(win, data, num_bits, offset, e->changed[part], e->unchanged[part]);
+}
+
+static int step_embed_lsbn(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                           size_t part, void *ctx) {
+    return embed_segments(win, first_byte, num_bits, offset, carry, part, (embed_ctx_t *)ctx, kernel_lsbn);
+}
+
+static int step_embed_lsbi(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                           size_t part, void *ctx) {
+    return embed_segments(win, first_byte, num_bits, offset, carry, part, (embed_ctx_t *)ctx, kernel_lsbi);
+}
+
+static int step_lsbi_histogram(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                               size_t part, void *ctx) {
+    return embed_segments(win, first_byte, num_bits, offset, carry, part, (embed_ctx_t *)ctx, kernel_lsbi_histogram);
+}
+
+static int step_extract_lsbn(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                             size_t part, void *ctx) {
+    extract_ctx_t *x = (extract_ctx_t *)ctx;
+    (void)part;
+    return lsbn_extract(win, x->lsb_bits, num_bits, x->buffer + first_byte, offset, carry);
+}
+
+static int step_extract_lsbi(BMPImage *win, size_t first_byte, size_t num_bits, size_t *offset, unsigned *carry,
+                             size_t part, void *ctx) {
+    extract_ctx_t *x = (extract_ctx_t *)ctx;
+    (void)carry;
+    (void)part;
+    return lsbi_extract(win, num_bits, x->buffer + first_byte, offset, &x->pattern_map);
+}
+
+static size_t capacity_bits(steg_method_t method, const BMPImage *win, size_t offset, unsigned carry) {
+    if (method == STEG_LSBI) {
+        return lsbi_capacity_bits(win, offset);
+    }
+    return lsbn_capacity_bits(win, steg_method_lsb_bits(method), offset, carry);
+}
+
+// Componente siguiente al último que usan `bytes` bytes a partir de `component` (con carry bits ya usados)
+static size_t end_component(steg_method_t method, size_t component, unsigned carry, size_t bytes) {
+    if (method == STEG_LSBI) {
+        if (bytes == 0) return component;
+        // El j-ésimo componente verde/azul (contando desde 0) es el índice j + j / 2
+        size_t last = (component - component / 3) + bytes * 8 - 1;
+        return last + last / 2 + 1;
+    }
+
+    unsigned n = steg_method_lsb_bits(method);
+    if (n == 0) {
+        return component;
+    }
+    return component + (carry + bytes * 8 + n - 1) / n;
+}
+
+typedef struct {
+    size_t first;        // Primer byte de la parte, relativo al paso
+    size_t bytes;
+    size_t offset;       // Componente donde arranca (índice local a la banda)
+    unsigned carry;
+    int rc;
+} band_part_t;
+
+typedef struct {
+    BMPImage *win;
+    band_step_fn step;
+    void *ctx;
+    size_t first_byte;
+    band_part_t *parts;
+} band_job_t;
+
+static void run_part(void *arg, size_t index) {
+    band_job_t *job = (band_job_t *)arg;
+    band_part_t *part = &job->parts[index];
+
+    part->rc = job->step(job->win, job->first_byte + part->first, part->bytes * 8,
+                         &part->offset, &part->carry, index, job->ctx);
+}
+
+// Componente (y bits ya usados de él) donde cae el bit `bit` contado desde `component`
+static size_t part_start(steg_method_t method, size_t component, size_t bit, unsigned *carry) {
+    if (method == STEG_LSBI) {
+        // Solo verde/azul: el j-ésimo de ellos es el índice j + j / 2
+        size_t gb = (component - component / 3) + bit;
+        *carry = 0;
+        return gb + gb / 2;
+    }
+
+    unsigned n = steg_method_lsb_bits(method);
+    *carry = (unsigned)(bit % n);
+    return component + bit / n;
+}
+
+/*
+ * Procesa bytes [first_byte, first_byte + bytes) del payload sobre la banda.
+ * La posición de cada byte en el portador se calcula directamente (también en
+ * LSBI, una vez fijado el pattern map), así que el rango se parte en tramos
+ * contiguos que empiezan en un límite de componente y se reparten entre los
+ * hilos del pool. Los tramos nunca comparten un byte del portador.
+ */
+static int band_step(StegBand *b, steg_method_t method, BMPImage *win, size_t first_byte, size_t bytes,
+                     size_t *local, band_step_fn step, void *ctx) {
+    unsigned n = method == STEG_LSBI ? 1 : steg_method_lsb_bits(method);
+    size_t parts = thread_pool_size(b->pool);
+
+    if (parts > bytes / STEG_PARALLEL_MIN_BYTES) {
+        parts = bytes / STEG_PARALLEL_MIN_BYTES;
+    }
+    if (parts > STEG_PARALLEL_MAX_PARTS) {
+        parts = STEG_PARALLEL_MAX_PARTS;
+    }
+
+    if (n == 0 || parts < 2) {
+        return step(win, first_byte, bytes * 8, local, &b->carry, 0, ctx);
+    }
+
+    // Bytes hasta el primer límite de componente; desde ahí cada n bytes son 8 componentes (LSBI: n = 1)
+    size_t lead = 0;
+    while ((b->carry + lead * 8) % n != 0) {
+        lead++;
+    }
+    size_t per = (bytes - lead) / parts / n * n;
+
+    band_part_t part[STEG_PARALLEL_MAX_PARTS];
+    for (size_t k = 0; k < parts; k++) {
+        size_t start = k == 0 ? 0 : lead + k * per;
+        size_t end = k + 1 == parts ? bytes : lead + (k + 1) * per;
+        part[k].first = start;
+        part[k].bytes = end - start;
+        part[k].offset = part_start(method, *local, b->carry + start * 8, &part[k].carry);
+        part[k].rc = 0;
+    }
+
+    band_job_t job = { win, step, ctx, first_byte, part };
+    thread_pool_run(b->pool, run_part, &job, parts);
+
+    for (size_t k = 0; k < parts; k++) {
+        if (part[k].rc != 0) {
+            return part[k].rc;
+        }
+    }
+
+    *local = part[parts - 1].offset;
+    b->carry = part[parts - 1].carry;
+    return 0;
+}
+
+static BMPImage band_image(const StegBand *b) {
+    BMPImage win;
+    memset(&win, 0, sizeof(win));
+    win.data = b->buf;
+    win.data_size = b->rows * b->row_size;
+    win.width = b->width;
+    win.height = b->rows;
+    return win;
+}
+
+static int band_init_stream(StegBand *b, const BmpStream *in, size_t band_size, ThreadPool *pool) {
+    memset(b, 0, sizeof(*b));
+    b->in = in;
+    b->pool = pool;
+    b->out_fd = -1;
+    b->width = in->width;
+    b->height = in->height;
+    b->row_size = in->rowSize;
+
+    if (b->row_size == 0 || b->height == 0) {
+        return -3;
+    }
+
+    b->band_rows = band_size / b->row_size;
+    if (b->band_rows < STEG_STREAM_MIN_ROWS) {
+        b->band_rows = STEG_STREAM_MIN_ROWS;
+    }
+    if (b->band_rows > b->height) {
+        b->band_rows = b->height;
+    }
+
+    b->buf = (uint8_t *)malloc(b->band_rows * b->row_size);
+    if (b->buf == NULL) {
+        return -2;
+    }
+
+    b->owns_buf = true;
+    return 0;
+}
+
+static void band_init_memory(StegBand *b, const BMPImage *img, ThreadPool *pool) {
+    memset(b, 0, sizeof(*b));
+    b->out_fd = -1;
+    b->pool = pool;
+    b->buf = img->data;
+    b->width = img->width;
+    b->height = img->height;
+    b->row_size = (img->width * 3 + 3) & ~(size_t)3;
+    b->band_rows = img->height;
+    b->rows = img->height;
+}
+
+static void band_free(StegBand *b) {
+    if (b->owns_buf) {
+        free(b->buf);
+    }
+    memset(b, 0, sizeof(*b));
+    b->out_fd = -1;
+}
+
+// Lee las filas que faltan hasta upto_row (sin pasar el tamaño de banda)
+static int band_fill(StegBand *b, size_t upto_row) {
+    size_t next_row = b->first_row + b->rows;
+    size_t limit = b->first_row + b->band_rows;
+
+    if (upto_row > limit) {
+        upto_row = limit;
+    }
+    if (upto_row > b->height) {
+        upto_row = b->height;
+    }
+
+    if (b->in == NULL || upto_row <= next_row) {
+        return 0;
+    }
+
+    size_t want = upto_row - next_row;
+    if (bmp_stream_read_rows(b->in, next_row, want, b->buf + b->rows * b->row_size) != 0) {
+        return -5;
+    }
+
+    b->rows += want;
+    return 0;
+}
+
+// Escribe las filas [first_row, upto_row) y corre el resto al inicio de la banda
+static int band_flush(StegBand *b, size_t upto_row) {
+    if (b->in == NULL) {
+        return 0;
+    }
+
+    size_t done_rows = upto_row - b->first_row;
+
+    if (done_rows == 0) {
+        return 0;
+    }
+
+    if (b->out_fd >= 0 && bmp_stream_write_rows(b->out_fd, b->in, b->first_row, done_rows, b->buf) != 0) {
+        return -4;
+    }
+
+    memmove(b->buf, b->buf + done_rows * b->row_size, (b->rows - done_rows) * b->row_size);
+    b->first_row = upto_row;
+    b->rows -= done_rows;
+    return 0;
+}
+
+/*
+ * Recorre len bytes de payload banda por banda: en cada banda se procesan los
+ * bytes completos que entran desde *component y se liberan las filas ya usadas.
+ * Solo se leen las filas que hacen falta para esos bytes.
+ * *component es el índice global de componente, igual que en los kernels.
+ */
+static int band_run(StegBand *b, steg_method_t method, size_t len,
+                    size_t *component, band_step_fn step, void *ctx) {
+    size_t components_per_row = b->width * 3;
+    size_t done = 0;
+
+    while (done < len) {
+        size_t end = end_component(method, *component, b->carry, len - done);
+        int rc = band_fill(b, (end + components_per_row - 1) / components_per_row);
+        if (rc != 0) {
+            return rc;
+        }
+
+        BMPImage win = band_image(b);
+        size_t local = *component - b->first_row * components_per_row;
+        size_t fit = capacity_bits(method, &win, local, b->carry) / 8;
+
+        if (fit > len - done) {
+            fit = len - done;
+        }
+
+        if (fit == 0) {
+            // Sin lugar para un byte más y sin filas por leer: no entra
+            if (b->first_row + b->rows >= b->height || b->rows == b->band_rows) {
+                return -3;
+            }
+        } else {
+            if (band_step(b, method, &win, done, fit, &local, step, ctx) != 0) {
+                return -6;
+            }
+            done += fit;
+            *component = b->first_row * components_per_row + local;
+        }
+
+        if (done < len) {
+            rc = band_flush(b, *component / components_per_row);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Primera pasada de LSBI (solo lectura): histograma de patrones sobre toda la
+ * región del payload, reducido en ctx->changed[0] / ctx->unchanged[0]. Deja la
+ * banda lista para la pasada de inserción.
+ */
+static int band_lsbi_histogram(StegBand *band, embed_ctx_t *ctx, size_t payload_len, size_t *component) {
+    *component = PATTERN_MAP_SIZE;
+
+    int rc = band_run(band, STEG_LSBI, payload_len, component, step_lsbi_histogram, ctx);
+    if (rc != 0) {
+        return rc;
+    }
+
+    // Reducción de los histogramas de cada tramo
+    for (size_t k = 1; k < STEG_PARALLEL_MAX_PARTS; k++) {
+        for (size_t p = 0; p < PATTERN_MAP_SIZE; p++) {
+            ctx->changed[0][p] += ctx->changed[k][p];
+            ctx->unchanged[0][p] += ctx->unchanged[k][p];
+        }
+    }
+
+    // Si la región entró en la primera banda, se reutiliza sin volver a leerla
+    if (band->first_row != 0) {
+        band->first_row = 0;
+        band->rows = 0;
+    }
+    return 0;
+}
+
+/*
+ * Oculta el payload sobre la banda ya inicializada. En LSBI primero recorre la
+ * región en modo solo lectura para armar el pattern map, salvo que llegue ya
+ * armado en lsbi_map (steg_writer_estimate_lsbi() hizo esa pasada); las filas
+ * se escriben solo en la pasada de inserción (band->out_fd se fija recién ahí).
+ */
+static int band_embed(StegBand *band, int out_fd, steg_method_t method, const uint8_t *lsbi_map,
+                      const StegSegment *segments, size_t segment_count, size_t *component) {
+    band_step_fn step = NULL;
+    unsigned lsb_bits = steg_method_lsb_bits(method);
+
+    if (method == STEG_LSBI) {
+        step = step_embed_lsbi;
+    } else if (lsb_bits > 0) {
+        step = step_embed_lsbn;
+    } else {
+        return -1;
+    }
+
+    embed_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.segments = segments;
+    ctx.segment_count = segment_count;
+    ctx.lsb_bits = lsb_bits;
+
+    size_t payload_len = 0;
+    for (size_t i = 0; i < segment_count; i++) {
+        payload_len += segments[i].length;
+    }
+
+    int rc = 0;
+
+    if (method == STEG_LSBI && lsbi_map != NULL) {
+        ctx.pattern_map = *lsbi_map;
+    } else if (method == STEG_LSBI) {
+        rc = band_lsbi_histogram(band, &ctx, payload_len, component);
+        if (rc != 0) {
+            return rc;
+        }
+        ctx.pattern_map = lsbi_pattern_map(ctx.changed[0], ctx.unchanged[0]);
+    }
+
+    band->out_fd = out_fd;
+
+    if (method == STEG_LSBI) {
+        band->carry = 0;
+        *component = 0;
+
+        uint8_t pattern_map_to_embed = ctx.pattern_map << 4;
+        rc = band_fill(band, (PATTERN_MAP_SIZE + band->width * 3 - 1) / (band->width * 3));
+
+        BMPImage win = band_image(band);
+        if (rc == 0 && lsb1_embed(&win, &pattern_map_to_embed, PATTERN_MAP_SIZE, component) != 0) {
+            rc = -3;
+        }
+    }
+
+    if (rc == 0) {
+        rc = band_run(band, method, payload_len, component, step, &ctx);
+    }
+
+    return rc;
+}
+
+int steg_writer_open_stream(StegWriter *w, const BmpStream *in, int out_fd, steg_method_t method,
+                            size_t band_size, ThreadPool *pool) {
+    if (w == NULL || in == NULL || out_fd < 0) {
+        return -1;
+    }
+
+    memset(w, 0, sizeof(*w));
+    w->method = method;
+    w->out_fd = out_fd;
+
+    int rc = band_init_stream(&w->band, in, band_size, pool);
+    if (rc != 0) {
+        band_free(&w->band);
+    }
+    return rc;
+}
+
+int steg_writer_open_memory(StegWriter *w, BMPImage *img, steg_method_t method, ThreadPool *pool) {
+    if (w == NULL || img == NULL || img->data == NULL) {
+        return -1;
+    }
+
+    memset(w, 0, sizeof(*w));
+    w->method = method;
+    w->out_fd = -1;
+    band_init_memory(&w->band, img, pool);
+    return 0;
+}
+
+int steg_writer_write(StegWriter *w, const StegSegment *segments, size_t segment_count) {
+    if (w == NULL || (segments == NULL && segment_count > 0)) {
+        return -1;
+    }
+
+    // LSBI arma el pattern map sobre todo el payload: tiene que llegar en una sola escritura
+    if (w->method == STEG_LSBI && w->written > 0) {
+        return -1;
+    }
+
+    int rc = band_embed(&w->band, w->out_fd, w->method, w->lsbi_map_ready ? &w->lsbi_map : NULL,
+                        segments, segment_count, &w->component);
+    w->lsbi_map_ready = false;
+    if (rc == 0) {
+        for (size_t i = 0; i < segment_count; i++) {
+            w->written += segments[i].length;
+        }
+    }
+    return rc;
+}
+
+int steg_writer_finish(StegWriter *w, bool copy_rest) {
+    // Filas pendientes de la última banda y, si la salida no parte de una copia
+    // del portador, el resto sin cambios
+    int rc = band_flush(&w->band, w->band.first_row + w->band.rows);
+
+    if (rc == 0 && copy_rest && w->band.in != NULL &&
+        bmp_stream_copy_rest(w->out_fd, w->band.in, w->band.first_row) != 0) {
+        rc = -4;
+    }
+    return rc;
+}
+
+int steg_writer_estimate_lsbi(StegWriter *w, const StegSegment *segments, size_t segment_count, size_t *changed) {
+    if (w == NULL || w->method != STEG_LSBI || w->written > 0 || w->lsbi_map_ready ||
+        (segments == NULL && segment_count > 0)) {
+        return -1;
+    }
+
+    embed_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.segments = segments;
+    ctx.segment_count = segment_count;
+
+    size_t payload_len = 0;
+    for (size_t i = 0; i < segment_count; i++) {
+        payload_len += segments[i].length;
+    }
+
+    size_t component = 0;
+    int rc = band_lsbi_histogram(&w->band, &ctx, payload_len, &component);
+    if (rc != 0) {
+        return rc;
+    }
+
+    // Un patrón invertido cambia justo los componentes que LSB1 dejaría igual
+    uint8_t map = lsbi_pattern_map(ctx.changed[0], ctx.unchanged[0]);
+    *changed = 0;
+    for (size_t p = 0; p < PATTERN_MAP_SIZE; p++) {
+        *changed += (map >> (3 - p)) & 1 ? ctx.unchanged[0][p] : ctx.changed[0][p];
+    }
+
+    // La escritura que sigue usa este mapa en vez de repetir el histograma
+    w->lsbi_map = map;
+    w->lsbi_map_ready = true;
+    return 0;
+}
+
+size_t steg_writer_components_used(const StegWriter *w) {
+    // El último componente puede haber quedado usado a medias (LSBn con n que no divide a 8)
+    return w->component + (w->band.carry != 0 ? 1 : 0);
+}
+
+void steg_writer_close(StegWriter *w) {
+    if (w != NULL) {
+        band_free(&w->band);
+    }
+}
+
+// Deja al lector listo en el primer componente de datos (después del pattern map en LSBI)
+static int reader_start(StegReader *r, steg_method_t method) {
+    r->method = method;
+    r->component = 0;
+    r->pattern_map = 0;
+
+    if (steg_method_lsb_bits(method) > 0) {
+        return 0;
+    }
+
+    switch (method) {
+        case STEG_LSBI: {
+            size_t components_per_row = r->band.width * 3;
+            int rc = band_fill(&r->band, (PATTERN_MAP_SIZE + components_per_row - 1) / components_per_row);
+            if (rc != 0) {
+                return rc;
+            }
+
+            BMPImage win = band_image(&r->band);
+            if (lsb1_extract(&win, PATTERN_MAP_SIZE, &r->pattern_map, &r->component) != 0) {
+                return -3;
+            }
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}
+
+int steg_reader_open_stream(StegReader *r, const BmpStream *in, steg_method_t method, size_t band_size,
+                            ThreadPool *pool) {
+    if (r == NULL || in == NULL) {
+        return -1;
+    }
+
+    int rc = band_init_stream(&r->band, in, band_size, pool);
+    if (rc == 0) {
+        rc = reader_start(r, method);
+    }
+    if (rc != 0) {
+        band_free(&r->band);
+    }
+    return rc;
+}
+
+int steg_reader_open_memory(StegReader *r, const BMPImage *img, steg_method_t method, ThreadPool *pool) {
+    if (r == NULL || img == NULL || img->data == NULL) {
+        return -1;
+    }
+
+    band_init_memory(&r->band, img, pool);
+    int rc = reader_start(r, method);
+    if (rc != 0) {
+        band_free(&r->band);
+    }
+    return rc;
+}
+
+int steg_reader_read(StegReader *r, uint8_t *buffer, size_t len) {
+    if (r == NULL || buffer == NULL) {
+        return -1;
+    }
+
+    band_step_fn step = NULL;
+    unsigned lsb_bits = steg_method_lsb_bits(r->method);
+
+    if (r->method == STEG_LSBI) {
+        step = step_extract_lsbi;
+    } else if (lsb_bits > 0) {
+        step = step_extract_lsbn;
+    } else {
+        return -1;
+    }
+
+    extract_ctx_t ctx;
+    ctx.buffer = buffer;
+    ctx.lsb_bits = lsb_bits;
+    ctx.pattern_map = r->pattern_map;
+
+    return band_run(&r->band, r->method, len, &r->component, step, &ctx);
+}
+
+int steg_reader_skip(StegReader *r, size_t len) {
+    if (r == NULL) {
+        return -1;
+    }
+
+    if (len > steg_reader_remaining(r)) {
+        return -3;
+    }
+
+    // La posición del byte siguiente se calcula directo, igual que al repartir tramos
+    unsigned carry = 0;
+    size_t component = part_start(r->method, r->component, r->band.carry + len * 8, &carry);
+    size_t row = component / (r->band.width * 3);
+
+    // Las filas salteadas no se leen: la banda se vacía o arranca en la fila del byte siguiente
+    if (r->band.in != NULL) {
+        if (row < r->band.first_row + r->band.rows) {
+            band_flush(&r->band, row);
+        } else {
+            r->band.first_row = row;
+            r->band.rows = 0;
+        }
+    }
+
+    r->component = component;
+    r->band.carry = carry;
+    return 0;
+}
+
+size_t steg_reader_remaining(const StegReader *r) {
+    BMPImage whole;
+    memset(&whole, 0, sizeof(whole));
+    whole.width = r->band.width;
+    whole.height = r->band.height;
+
+    return capacity_bits(r->method, &whole, r->component, r->band.carry) / 8;
+}
+
+size_t steg_capacity_bytes(steg_method_t method, size_t width, size_t height) {
+    if (method == STEG_NONE) {
+        return 0;
+    }
+
+    BMPImage whole;
+    memset(&whole, 0, sizeof(whole));
+    whole.width = width;
+    whole.height = height;
+
+    // Mismo punto de partida que el writer: en LSBI los datos van después del pattern map
+    return capacity_bits(method, &whole, method == STEG_LSBI ? PATTERN_MAP_SIZE : 0, 0) / 8;
+}
+
+void steg_reader_close(StegReader *r) {
+    if (r != NULL) {
+        band_free(&r->band);
+    }
+}
@@ -0,0 +1,260 @@
+#ifndef STEG_STREAM_H
+#define STEG_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../bmp_handler/bmp_stream.h"
+#include "../common/bmp_image.h"
+#include "../utils/parser/parser.h"
+#include "../utils/thread_pool/thread_pool.h"
+
+/**
+ * @file steg_stream.h
+ * @brief Band-by-band embedding with memory bounded by the band size
+ * 
+ * The carrier is processed in bands of whole rows: each band is read, the
+ * LSBn/LSBI kernel embeds every payload byte that fits in it, and the
+ * finished rows are written to the output before the next rows are read.
+ * Rows holding a partially used payload byte are carried over to the next band.
+ * Only the rows covering the requested payload bytes are ever read, so small
+ * payloads cost I/O proportional to the payload, not to the image.
+ * 
+ * With a thread pool, the payload bytes of each band are split into contiguous
+ * ranges that start on component boundaries and are embedded or extracted in
+ * parallel; the result is the same as with a single thread. LSBI keeps one
+ * pattern histogram per range and adds them up before choosing the map.
+ */
+
+/** Default band size in bytes when streaming is enabled without -band */
+#define STEG_STREAM_DEFAULT_BAND (4u << 20)
+
+/** Minimum rows per band, so that at least one payload byte always fits */
+#define STEG_STREAM_MIN_ROWS 16
+
+/** Minimum payload bytes per parallel range; smaller steps run on one thread */
+#define STEG_PARALLEL_MIN_BYTES (64u << 10)
+
+/** Maximum parallel ranges per band step */
+#define STEG_PARALLEL_MAX_PARTS 256
+
+/**
+ * @brief Window of consecutive carrier rows
+ * 
+ * Either backed by a BmpStream (rows are read and written on demand) or by an
+ * image already resident in memory (in == NULL, all rows present, nothing is copied).
+ */
+typedef struct {
+    const BmpStream *in; /**< Carrier stream, NULL when all rows are resident */
+    int out_fd;          /**< Output descriptor, -1 for read-only passes */
+    uint8_t *buf;        /**< Row buffer (band_rows * row_size bytes) */
+    bool owns_buf;       /**< Whether buf was allocated by the band */
+    size_t width;        /**< Image width in pixels */
+    size_t height;       /**< Image height in pixels */
+    size_t row_size;     /**< Bytes per row, including padding */
+    size_t band_rows;    /**< Maximum rows held at once */
+    size_t first_row;    /**< Global index of the row at buf[0] */
+    size_t rows;         /**< Rows currently loaded */
+    unsigned carry;      /**< LSBn bits already used in the current component (n not dividing 8) */
+    ThreadPool *pool;    /**< Workers for the LSBn kernels, NULL for a single thread */
+} StegBand;
+
+/**
+ * @brief Contiguous piece of the payload
+ * 
+ * The payload to embed is the concatenation of its segments, so the size
+ * header, the file data and the extension can be embedded straight from where
+ * they live without assembling a copy.
+ */
+typedef struct {
+    const uint8_t *data; /**< Segment bytes */
+    size_t length;       /**< Segment length in bytes */
+} StegSegment;
+
+/**
+ * @brief Sequential extractor over a carrier
+ * 
+ * Returns the hidden bytes in order, reading carrier rows lazily. For LSBI the
+ * pattern map is read when the reader is opened.
+ */
+typedef struct {
+    StegBand band;         /**< Carrier window */
+    steg_method_t method;  /**< Steganography method */
+    size_t component;      /**< Next component index to read */
+    uint8_t pattern_map;   /**< LSBI pattern map as stored (map << 4) */
+} StegReader;
+
+/**
+ * @brief Sequential embedder over a carrier
+ * 
+ * Takes the payload in consecutive pieces, so it can be produced while it is
+ * being embedded (e.g. ciphertext chunks). LSBn accepts any number of writes;
+ * LSBI needs the whole payload in a single write, since the pattern map
+ * depends on all of it.
+ */
+typedef struct {
+    StegBand band;         /**< Carrier window */
+    steg_method_t method;  /**< Steganography method */
+    int out_fd;            /**< Output descriptor, -1 for an image in memory */
+    size_t component;      /**< Next component index to write */
+    size_t written;        /**< Payload bytes embedded so far */
+    uint8_t lsbi_map;      /**< LSBI pattern map chosen by steg_writer_estimate_lsbi() */
+    bool lsbi_map_ready;   /**< lsbi_map is set and the histogram pass is already done */
+} StegWriter;
+
+/**
+ * @brief Opens a writer that reads carrier rows on demand and writes them to out_fd
+ * 
+ * After steg_writer_finish() with copy_rest the output is byte-identical to
+ * bmp_read() + in-memory embed + bmp_write(). Without it only the rows up to
+ * the last modified one are written, for outputs that already hold a copy of
+ * the carrier (clone or in-place patch). LSBI reads the payload region twice:
+ * a read-only histogram pass to build the pattern map and the embedding pass
+ * (the first one is skipped when steg_writer_estimate_lsbi() already ran it).
+ * 
+ * @param w Writer to initialize
+ * @param in Open carrier stream (must outlive the writer)
+ * @param out_fd Output descriptor (from bmp_stream_create(), clone_file() or the carrier itself); not closed
+ * @param method Steganography method (LSB1..LSB8 or LSBI)
+ * @param band_size Maximum bytes of carrier rows held in memory
+ * @param pool Thread pool for the kernels, NULL for a single thread
+ * 
+ * @return 0 on success, negative error code on failure:
+ *         -1: Invalid arguments or steganography method
+ *         -2: Memory allocation failed
+ *         -3: Insufficient capacity
+ *         -4: Failed to write the output
+ *         -5: Failed to read the carrier
+ *         -6: Embedding kernel failed
+ */
+int steg_writer_open_stream(StegWriter *w, const BmpStream *in, int out_fd, steg_method_t method,
+                            size_t band_size, ThreadPool *pool);
+
+/**
+ * @brief Opens a writer over an image already in memory (modified in place)
+ * 
+ * @return 0 on success, negative error code on failure
+ */
+int steg_writer_open_memory(StegWriter *w, BMPImage *img, steg_method_t method, ThreadPool *pool);
+
+/**
+ * @brief Embeds the next payload bytes right after the previous ones
+ * 
+ * @param w Open writer
+ * @param segments Payload pieces in order
+ * @param segment_count Number of segments
+ * 
+ * @return 0 on success, negative error code on failure (same codes as steg_writer_open_stream());
+ *         -1 for a second LSBI write
+ */
+int steg_writer_write(StegWriter *w, const StegSegment *segments, size_t segment_count);
+
+/**
+ * @brief Counts the components an LSBI embed of the payload would change, without changing any
+ * 
+ * Runs the read-only histogram pass of LSBI and applies the pattern map it
+ * would choose. The writer keeps that map, so the steg_writer_write() that
+ * follows skips its own histogram pass; that write must carry the same payload.
+ * 
+ * @param w Writer opened with STEG_LSBI, before any write
+ * @param segments Payload pieces in order
+ * @param segment_count Number of segments
+ * @param changed Receives the number of green/blue components whose LSB would flip
+ *                (the 4 pattern map components are not included)
+ * 
+ * @return 0 on success, negative error code on failure (same codes as steg_writer_open_stream())
+ */
+int steg_writer_estimate_lsbi(StegWriter *w, const StegSegment *segments, size_t segment_count, size_t *changed);
+
+/**
+ * @brief Writes the pending rows and, with copy_rest, the unmodified rest of the carrier
+ * 
+ * @return 0 on success, -4 if the output could not be written
+ */
+int steg_writer_finish(StegWriter *w, bool copy_rest);
+
+/**
+ * @brief Number of components touched so far (index after the last one modified)
+ */
+size_t steg_writer_components_used(const StegWriter *w);
+
+/**
+ * @brief Releases the writer's band buffer (out_fd is not closed)
+ */
+void steg_writer_close(StegWriter *w);
+
+/**
+ * @brief Opens a reader that pulls rows from a carrier stream on demand
+ * 
+ * @param r Reader to initialize
+ * @param in Open carrier stream (must outlive the reader)
+ * @param method Steganography method (LSB1..LSB8 or LSBI)
+ * @param band_size Maximum bytes of carrier rows held in memory
+ * @param pool Thread pool for the kernels, NULL for a single thread
+ * 
+ * @return 0 on success, negative error code on failure (same codes as steg_writer_open_stream())
+ */
+int steg_reader_open_stream(StegReader *r, const BmpStream *in, steg_method_t method, size_t band_size,
+                            ThreadPool *pool);
+
+/**
+ * @brief Opens a reader over an image already in memory
+ * 
+ * @param r Reader to initialize
+ * @param img Image whose pixels stay valid while the reader is used
+ * @param method Steganography method (LSB1..LSB8 or LSBI)
+ * @param pool Thread pool for the kernels, NULL for a single thread
+ * 
+ * @return 0 on success, negative error code on failure
+ */
+int steg_reader_open_memory(StegReader *r, const BMPImage *img, steg_method_t method, ThreadPool *pool);
+
+/**
+ * @brief Extracts the next len hidden bytes
+ * 
+ * @param r Open reader
+ * @param buffer Output buffer of at least len bytes
+ * @param len Number of bytes to extract
+ * 
+ * @return 0 on success, -3 if the carrier has fewer bytes left, other negative codes on I/O error
+ */
+int steg_reader_read(StegReader *r, uint8_t *buffer, size_t len);
+
+/**
+ * @brief Moves past the next len hidden bytes without extracting them
+ * 
+ * The position of any hidden byte is computed directly, so skipped carrier
+ * rows are never read.
+ * 
+ * @param r Open reader
+ * @param len Number of bytes to skip
+ * 
+ * @return 0 on success, -3 if the carrier has fewer bytes left
+ */
+int steg_reader_skip(StegReader *r, size_t len);
+
+/**
+ * @brief Number of whole bytes still available to the reader
+ */
+size_t steg_reader_remaining(const StegReader *r);
+
+/**
+ * @brief Exact number of payload bytes a carrier of the given size can hold
+ * 
+ * Only the width * height * 3 pixel components count (row padding is never
+ * used). LSBI hides data only in green and blue components, after the
+ * PATTERN_MAP_SIZE components holding the pattern map. Depends on the headers
+ * alone, so it needs no pixel data.
+ * 
+ * @return Bytes available to the whole hidden block (size header included), 0 for STEG_NONE
+ */
+size_t steg_capacity_bytes(steg_method_t method, size_t width, size_t height);
+
+/**
+ * @brief Releases the reader's band buffer
+ * 
+ * @note Safe to call multiple times; does not close the carrier stream
+ */
+void steg_reader_close(StegReader *r);
+
+#endif // STEG_STREAM_H
@@ -0,0 +1,207 @@
+#include "batch.h"
+#include "../../bmp_handler/bmp_cache.h"
+#include "../file_management/file_management.h"
+#include "../operations/operations.h"
+#include "../thread_pool/thread_pool.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    size_t line;        // Línea del manifiesto (desde 1)
+    char **argv;        // "stegobmp" + argumentos, apuntan al buffer del manifiesto
+    int argc;           // -1 si la línea no se pudo partir
+} batch_job_t;
+
+typedef struct {
+    const char *manifest;
+    batch_job_t *jobs;
+    size_t count;
+    FILE *report;
+    BmpCache *cache;    // Portadores compartidos entre trabajos, NULL con -cache 0
+    pthread_mutex_t lock;
+    size_t failed;
+} batch_t;
+
+// Arma un trabajo por cada línea no vacía del manifiesto
+static int load_jobs(batch_t *batch, char *text)
+{
+    size_t capacity = 0;
+    size_t line = 0;
+    char *next = text;
+
+    while (next != NULL) {
+        char *current = next;
+        next = strchr(current, '\n');
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+        line++;
+
+        size_t length = strlen(current);
+        if (length > 0 && current[length - 1] == '\r') {
+            current[length - 1] = '\0';
+        }
+
+        batch_job_t job;
+        memset(&job, 0, sizeof(job));
+        job.line = line;
+
+        int rc = split_arguments(current, &job.argc, &job.argv);
+        if (rc == 1) {
+            free(job.argv);
+            continue;
+        }
+        if (rc != 0) {
+            job.argc = -1;
+        }
+
+        if (batch->count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 64;
+            batch_job_t *jobs = (batch_job_t *)realloc(batch->jobs, grown * sizeof(batch_job_t));
+            if (jobs == NULL) {
+                free(job.argv);
+                return -1;
+            }
+            batch->jobs = jobs;
+            capacity = grown;
+        }
+        batch->jobs[batch->count++] = job;
+    }
+
+    return 0;
+}
+
+static void report_job(batch_t *batch, const batch_job_t *job, OperationsResult rc)
+{
+    pthread_mutex_lock(&batch->lock);
+    fprintf(batch->report, "%zu\t%d\t%s\n", job->line, (int)rc, operations_result_to_string(rc));
+    fflush(batch->report);
+    if (rc != OPS_OK) {
+        batch->failed++;
+    }
+    pthread_mutex_unlock(&batch->lock);
+}
+
+static void run_job(void *arg, size_t index)
+{
+    batch_t *batch = (batch_t *)arg;
+    const batch_job_t *job = &batch->jobs[index];
+    OperationsResult rc = OPS_INVALID_ARGUMENTS;
+
+    if (job->argc < 0) {
+        fprintf(stderr, "%s:%zu: Error: Comillas sin cerrar\n", batch->manifest, job->line);
+        report_job(batch, job, rc);
+        return;
+    }
+
+    stegobmp_config_t config;
+    if (parse_arguments(job->argc, job->argv, &config) != 0) {
+        fprintf(stderr, "%s:%zu: %s\n", batch->manifest, job->line, config.error_message);
+    } else if (config.operation == OP_BATCH) {
+        fprintf(stderr, "%s:%zu: Error: -batch no se puede anidar\n", batch->manifest, job->line);
+    } else {
+        // Los trabajos ya corren en paralelo: sin -threads cada uno usa un solo hilo
+        if (config.threads == 0) {
+            config.threads = 1;
+        }
+        config.carrier_cache = batch->cache;
+        rc = perform_operation(&config);
+    }
+
+    free_config(&config);
+    report_job(batch, job, rc);
+}
+
+int batch_run(const stegobmp_config_t *config)
+{
+    uint8_t *data = NULL;
+    size_t length = 0;
+
+    if (read_file(config->batch_file, &data, &length) != 0) {
+        fprintf(stderr, "Error: No pude leer el manifiesto '%s'\n", config->batch_file);
+        return -1;
+    }
+
+    char *text = (char *)realloc(data, length + 1);
+    if (text == NULL) {
+        fprintf(stderr, "Error: No pude leer el manifiesto '%s'\n", config->batch_file);
+        free(data);
+        return -1;
+    }
+    text[length] = '\0';
+
+    batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.manifest = config->batch_file;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    if (load_jobs(&batch, text) != 0) {
+        fprintf(stderr, "Error: No pude asignar memoria para el manifiesto\n");
+        for (size_t i = 0; i < batch.count; i++) {
+            free(batch.jobs[i].argv);
+        }
+        free(batch.jobs);
+        free(text);
+        pthread_mutex_destroy(&batch.lock);
+        return -1;
+    }
+
+    // El reporte va al stdout original; los mensajes de progreso de los trabajos se descartan
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    batch.report = saved_stdout >= 0 ? fdopen(saved_stdout, "w") : NULL;
+
+    if (batch.report != NULL && devnull >= 0 && dup2(devnull, STDOUT_FILENO) >= 0) {
+        close(devnull);
+    } else {
+        if (batch.report != NULL) {
+            fclose(batch.report);
+        } else if (saved_stdout >= 0) {
+            close(saved_stdout);
+        }
+        if (devnull >= 0) {
+            close(devnull);
+        }
+        batch.report = stdout;
+    }
+
+    if (!config->no_cache) {
+        batch.cache = bmp_cache_create(config->cache_size ? config->cache_size : BMP_CACHE_DEFAULT_BUDGET);
+    }
+
+    ThreadPool *pool = thread_pool_create(config->threads);
+    thread_pool_run(pool, run_job, &batch, batch.count);
+    thread_pool_destroy(pool);
+
+    if (batch.cache != NULL) {
+        size_t hits, misses;
+        bmp_cache_stats(batch.cache, &hits, &misses);
+        fprintf(stderr, "[cache] %zu aciertos, %zu lecturas de portador\n", hits, misses);
+        bmp_cache_destroy(batch.cache);
+    }
+
+    fprintf(batch.report, "# jobs=%zu ok=%zu failed=%zu\n", batch.count, batch.count - batch.failed, batch.failed);
+
+    if (batch.report != stdout) {
+        fflush(stdout);
+        dup2(fileno(batch.report), STDOUT_FILENO);
+        fclose(batch.report);
+    } else {
+        fflush(stdout);
+    }
+
+    for (size_t i = 0; i < batch.count; i++) {
+        free(batch.jobs[i].argv);
+    }
+    free(batch.jobs);
+    free(text);
+    pthread_mutex_destroy(&batch.lock);
+
+    return (int)batch.failed;
+}
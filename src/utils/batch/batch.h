@@ -0,0 +1,46 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include "../parser/parser.h"
+
+/**
+ * @file batch.h
+ * @brief Runs many embed/extract jobs from a manifest in a single process
+ *
+ * Each non-empty manifest line is one job written with the same options as the
+ * command line (without the program name), e.g.
+ *
+ *     -embed -in a.txt -p c.bmp -out a.bmp -steg LSB1
+ *     -extract -p "my file.bmp" -out rec -steg LSBI -pass 'se cret'
+ *
+ * Arguments are split on whitespace; single quotes, double quotes and
+ * backslashes work as in a shell, and '#' starts a comment. The jobs run on a
+ * fixed pool of workers and a failing job does not stop the others. Carriers
+ * used by several jobs are read once into a BmpCache (budget set by -cache).
+ *
+ * The report goes to standard output, one line per job as it finishes:
+ *
+ *     <line>\t<code>\t<name>
+ *
+ * where code is the job's OperationsResult and name its symbolic form (see
+ * operations_result_to_string()), followed by a final
+ *
+ *     # jobs=<n> ok=<n> failed=<n>
+ *
+ * The jobs' own progress messages are discarded; errors still go to stderr.
+ */
+
+/**
+ * @brief Runs every job of config->batch_file
+ *
+ * @param config Batch configuration; config->threads workers (0 = online CPUs)
+ *
+ * @return Number of failed jobs, or -1 if the manifest could not be read
+ *
+ * @note Jobs without -threads run their kernels on one thread, so the pool is
+ *       not oversubscribed
+ */
+int batch_run(const stegobmp_config_t *config);
+
+#endif // BATCH_H
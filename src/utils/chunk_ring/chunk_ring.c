@@ -0,0 +1,94 @@
+#include "chunk_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+int chunk_ring_init(ChunkRing *ring, size_t slots, size_t slot_size) {
+    memset(ring, 0, sizeof(*ring));
+
+    if (slots == 0 || slot_size == 0) {
+        return -1;
+    }
+
+    ring->buffer = (uint8_t *)malloc(slots * slot_size);
+    ring->lengths = (size_t *)calloc(slots, sizeof(size_t));
+    if (ring->buffer == NULL || ring->lengths == NULL) {
+        free(ring->buffer);
+        free(ring->lengths);
+        memset(ring, 0, sizeof(*ring));
+        return -1;
+    }
+
+    ring->slots = slots;
+    ring->slot_size = slot_size;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->changed, NULL);
+    return 0;
+}
+
+uint8_t *chunk_ring_acquire(ChunkRing *ring) {
+    pthread_mutex_lock(&ring->lock);
+    while (!ring->aborted && ring->head - ring->tail == ring->slots) {
+        pthread_cond_wait(&ring->changed, &ring->lock);
+    }
+    bool aborted = ring->aborted;
+    size_t slot = ring->head % ring->slots;
+    pthread_mutex_unlock(&ring->lock);
+
+    // El slot head está libre hasta el commit: el consumidor no lo toca
+    return aborted ? NULL : ring->buffer + slot * ring->slot_size;
+}
+
+void chunk_ring_commit(ChunkRing *ring, size_t length) {
+    pthread_mutex_lock(&ring->lock);
+    ring->lengths[ring->head % ring->slots] = length;
+    ring->head++;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void chunk_ring_close(ChunkRing *ring, int status) {
+    pthread_mutex_lock(&ring->lock);
+    ring->closed = true;
+    ring->status = status;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+const uint8_t *chunk_ring_peek(ChunkRing *ring, size_t *length) {
+    pthread_mutex_lock(&ring->lock);
+    while (!ring->closed && ring->head == ring->tail) {
+        pthread_cond_wait(&ring->changed, &ring->lock);
+    }
+    bool empty = ring->head == ring->tail;
+    size_t slot = ring->tail % ring->slots;
+    *length = empty ? 0 : ring->lengths[slot];
+    pthread_mutex_unlock(&ring->lock);
+
+    return empty ? NULL : ring->buffer + slot * ring->slot_size;
+}
+
+void chunk_ring_release(ChunkRing *ring) {
+    pthread_mutex_lock(&ring->lock);
+    ring->tail++;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void chunk_ring_abort(ChunkRing *ring) {
+    pthread_mutex_lock(&ring->lock);
+    ring->aborted = true;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void chunk_ring_destroy(ChunkRing *ring) {
+    if (ring->buffer == NULL) {
+        return;
+    }
+
+    pthread_cond_destroy(&ring->changed);
+    pthread_mutex_destroy(&ring->lock);
+    free(ring->buffer);
+    free(ring->lengths);
+    memset(ring, 0, sizeof(*ring));
+}
@@ -0,0 +1,90 @@
+#ifndef CHUNK_RING_H
+#define CHUNK_RING_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file chunk_ring.h
+ * @brief Fixed ring of buffers handed from one producer thread to one consumer
+ *
+ * The producer fills a free slot and commits it; the consumer takes filled
+ * slots in order and releases them once used. Memory stays at
+ * slots * slot_size no matter how much data goes through.
+ */
+
+/** Default number of slots for the crypto pipelines */
+#define CHUNK_RING_DEFAULT_SLOTS 4
+
+/** Default slot size for the crypto pipelines */
+#define CHUNK_RING_DEFAULT_SLOT_SIZE (1u << 20)
+
+typedef struct {
+    uint8_t *buffer;         /**< slots * slot_size bytes */
+    size_t *lengths;         /**< Bytes committed in each slot */
+    size_t slots;            /**< Number of slots */
+    size_t slot_size;        /**< Bytes per slot */
+    size_t head;             /**< Slots committed so far */
+    size_t tail;             /**< Slots released so far */
+    bool closed;             /**< Producer finished (see status) */
+    bool aborted;            /**< Consumer gave up: the producer must stop */
+    int status;              /**< Producer result passed to chunk_ring_close() */
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} ChunkRing;
+
+/**
+ * @brief Allocates the ring
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int chunk_ring_init(ChunkRing *ring, size_t slots, size_t slot_size);
+
+/**
+ * @brief Producer: waits for a free slot
+ *
+ * @return Slot buffer of slot_size bytes, or NULL if the consumer aborted
+ */
+uint8_t *chunk_ring_acquire(ChunkRing *ring);
+
+/**
+ * @brief Producer: publishes the slot returned by chunk_ring_acquire()
+ *
+ * @param length Bytes written to the slot
+ */
+void chunk_ring_commit(ChunkRing *ring, size_t length);
+
+/**
+ * @brief Producer: no more slots will be committed
+ *
+ * @param status 0 if everything was produced, negative error code otherwise
+ */
+void chunk_ring_close(ChunkRing *ring, int status);
+
+/**
+ * @brief Consumer: waits for the next filled slot
+ *
+ * @param length Receives the bytes in the slot
+ *
+ * @return Slot data, or NULL once the producer closed the ring and every slot was taken
+ */
+const uint8_t *chunk_ring_peek(ChunkRing *ring, size_t *length);
+
+/**
+ * @brief Consumer: returns the slot obtained with chunk_ring_peek() to the producer
+ */
+void chunk_ring_release(ChunkRing *ring);
+
+/**
+ * @brief Consumer: stops the producer (its next chunk_ring_acquire() returns NULL)
+ */
+void chunk_ring_abort(ChunkRing *ring);
+
+/**
+ * @brief Frees the ring
+ */
+void chunk_ring_destroy(ChunkRing *ring);
+
+#endif // CHUNK_RING_H
@@ -1,6 +1,16 @@
+#define _GNU_SOURCE
 #include "file_management.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
 
 int read_file(const char *path, uint8_t **buf, size_t *len) {
     *buf = NULL; *len = 0;
@@ -59,4 +69,248 @@ int write_file(const char *path, const uint8_t *buf, size_t len) {
     fclose(f);
 
     return 0;
-}
\ No newline at end of file
+}
+
+int pread_all(int fd, void *buf, size_t len, off_t off) {
+    uint8_t *p = (uint8_t*)buf;
+
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, off);
+
+        if (n < 0 && errno == EINTR) 
+            continue;
+
+        if (n <= 0) 
+            return -1;
+
+        p += n;
+        off += n;
+        len -= (size_t)n;
+    }
+
+    return 0;
+}
+
+int pwrite_all(int fd, const void *buf, size_t len, off_t off) {
+    const uint8_t *p = (const uint8_t*)buf;
+
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, off);
+
+        if (n < 0 && errno == EINTR) 
+            continue;
+
+        if (n <= 0) 
+            return -1;
+
+        p += n;
+        off += n;
+        len -= (size_t)n;
+    }
+
+    return 0;
+}
+
+int write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t*)buf;
+
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+
+        if (n < 0 && errno == EINTR) 
+            continue;
+
+        if (n <= 0) 
+            return -1;
+
+        p += n;
+        len -= (size_t)n;
+    }
+
+    return 0;
+}
+
+int copy_file_region(int in_fd, int out_fd, off_t off, size_t len) {
+#ifdef __linux__
+    // Copia dentro del kernel (y server-side/reflink en los filesystems que lo soportan)
+    off_t in_off = off, out_off = off;
+
+    while (len > 0) {
+        ssize_t n = copy_file_range(in_fd, &in_off, out_fd, &out_off, len, 0);
+
+        if (n < 0 && errno == EINTR) 
+            continue;
+
+        if (n <= 0) 
+            break;
+
+        len -= (size_t)n;
+    }
+
+    off = in_off;
+#endif
+
+    uint8_t buf[64 * 1024];
+
+    while (len > 0) {
+        size_t chunk = len < sizeof(buf) ? len : sizeof(buf);
+
+        if (pread_all(in_fd, buf, chunk, off) != 0 || pwrite_all(out_fd, buf, chunk, off) != 0) 
+            return -1;
+
+        off += (off_t)chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+int clone_file(const char *src_path, const char *dst_path) {
+    int in_fd = open(src_path, O_RDONLY);
+
+    if (in_fd < 0) 
+        return -1;
+
+    struct stat in_st, out_st;
+
+    if (fstat(in_fd, &in_st) != 0) { 
+        close(in_fd); 
+        return -1; 
+    }
+
+    // Sin O_TRUNC: si destino y origen son el mismo archivo no hay nada que copiar
+    int out_fd = open(dst_path, O_WRONLY | O_CREAT, 0666);
+
+    if (out_fd < 0 || fstat(out_fd, &out_st) != 0) { 
+        if (out_fd >= 0) close(out_fd);
+        close(in_fd); 
+        return -1; 
+    }
+
+    if (in_st.st_dev == out_st.st_dev && in_st.st_ino == out_st.st_ino) { 
+        close(in_fd); 
+        return out_fd; 
+    }
+
+    if (ftruncate(out_fd, 0) != 0) { 
+        close(out_fd); 
+        close(in_fd); 
+        return -1; 
+    }
+
+#ifdef FICLONE
+    // Reflink: comparte los extents del portador (btrfs, XFS, ...)
+    if (ioctl(out_fd, FICLONE, in_fd) == 0) { 
+        close(in_fd); 
+        return out_fd; 
+    }
+#endif
+
+    if (copy_file_region(in_fd, out_fd, 0, (size_t)in_st.st_size) != 0) { 
+        close(out_fd); 
+        close(in_fd); 
+        return -1; 
+    }
+
+    close(in_fd);
+    return out_fd;
+}
+
+// Umask del proceso sin cambiarla (umask() la pisa, y otros hilos pueden estar creando archivos)
+static mode_t current_umask(void) {
+    FILE *f = fopen("/proc/self/status", "re");
+    unsigned int mask = 022;
+    char line[128];
+
+    if (f == NULL) 
+        return (mode_t)mask;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "Umask: %o", &mask) == 1) 
+            break;
+    }
+
+    fclose(f);
+    return (mode_t)mask;
+}
+
+// Un descriptor pasado por nombre (-serve): reemplazar el nombre dejaría al cliente con el archivo viejo
+static int is_descriptor_path(const char *path) {
+    return strncmp(path, "/proc/self/fd/", 14) == 0 || strncmp(path, "/dev/fd/", 8) == 0;
+}
+
+int output_file_open(const char *path, OutputFile *out) {
+    memset(out, 0, sizeof(*out));
+    out->fd = -1;
+
+    struct stat st;
+    int exists = stat(path, &st) == 0;
+
+    if (is_descriptor_path(path) || (exists && !S_ISREG(st.st_mode))) {
+        out->path = strdup(path);
+        out->fd = out->path != NULL ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666) : -1;
+        if (out->fd < 0) {
+            output_file_discard(out);
+            return -1;
+        }
+        return 0;
+    }
+
+    // El temporal va junto al archivo real: rename() no cruza sistemas de archivos
+    out->path = exists ? realpath(path, NULL) : strdup(path);
+    if (out->path == NULL || asprintf(&out->temp_path, "%s.XXXXXX", out->path) < 0) {
+        out->temp_path = NULL;
+        output_file_discard(out);
+        return -1;
+    }
+
+    out->fd = mkostemp(out->temp_path, O_CLOEXEC);
+    if (out->fd < 0) {
+        free(out->temp_path);
+        out->temp_path = NULL;
+        output_file_discard(out);
+        return -1;
+    }
+
+    // mkstemp crea con 0600: se deja el modo que tendría el destino
+    mode_t mode = exists ? (st.st_mode & 07777) : (0666 & ~current_umask());
+    if (fchmod(out->fd, mode) != 0) {
+        output_file_discard(out);
+        return -1;
+    }
+
+    return 0;
+}
+
+int output_file_commit(OutputFile *out) {
+    int rc = 0;
+
+    if (out->fd >= 0 && close(out->fd) != 0) 
+        rc = -1;
+    out->fd = -1;
+
+    if (rc == 0 && out->temp_path != NULL && rename(out->temp_path, out->path) != 0) 
+        rc = -1;
+
+    if (rc == 0) {
+        free(out->temp_path);
+        out->temp_path = NULL;
+    }
+
+    output_file_discard(out);
+    return rc;
+}
+
+void output_file_discard(OutputFile *out) {
+    if (out->fd >= 0) 
+        close(out->fd);
+    out->fd = -1;
+
+    if (out->temp_path != NULL) 
+        unlink(out->temp_path);
+
+    free(out->temp_path);
+    free(out->path);
+    out->temp_path = NULL;
+    out->path = NULL;
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/types.h>
 
 /**
  * @brief Reads the entire contents of a file into memory
@@ -46,4 +47,115 @@ int read_file(const char *path, uint8_t **buf, size_t *len);
  */
 int write_file(const char *path, const uint8_t *buf, size_t len);
 
+/**
+ * @brief Reads exactly len bytes from a file descriptor at the given offset
+ * 
+ * @param fd Open file descriptor
+ * @param buf Destination buffer
+ * @param len Number of bytes to read
+ * @param off File offset to read from
+ * 
+ * @return 0 on success, -1 on I/O error or premature end of file
+ * 
+ * @note Retries short reads and EINTR; the file position is not changed
+ */
+int pread_all(int fd, void *buf, size_t len, off_t off);
+
+/**
+ * @brief Writes exactly len bytes to a file descriptor at the given offset
+ * 
+ * @param fd Open file descriptor
+ * @param buf Source buffer
+ * @param len Number of bytes to write
+ * @param off File offset to write at
+ * 
+ * @return 0 on success, -1 on I/O error
+ * 
+ * @note Retries short writes and EINTR; the file position is not changed
+ */
+int pwrite_all(int fd, const void *buf, size_t len, off_t off);
+
+/**
+ * @brief Writes exactly len bytes at the current position of a file descriptor
+ * 
+ * @param fd Open file descriptor (regular file, pipe or terminal)
+ * @param buf Source buffer
+ * @param len Number of bytes to write
+ * 
+ * @return 0 on success, -1 on I/O error
+ * 
+ * @note Retries short writes and EINTR
+ */
+int write_all(int fd, const void *buf, size_t len);
+
+/**
+ * @brief Copies a byte range between two files at the same offset
+ * 
+ * Uses copy_file_range() so the data never enters user space (and may be
+ * offloaded by the filesystem), falling back to a pread/pwrite loop.
+ * 
+ * @param in_fd Source file descriptor
+ * @param out_fd Destination file descriptor
+ * @param off Offset of the range in both files
+ * @param len Number of bytes to copy
+ * 
+ * @return 0 on success, -1 on I/O error
+ */
+int copy_file_region(int in_fd, int out_fd, off_t off, size_t len);
+
+/**
+ * @brief Creates dst_path as a copy of src_path, sharing storage when possible
+ * 
+ * Tries a reflink (FICLONE), then copy_file_range(), then a plain copy. If both
+ * paths name the same file, nothing is copied.
+ * 
+ * @param src_path File to clone
+ * @param dst_path Destination file (created or replaced)
+ * 
+ * @return File descriptor of the destination opened for writing, -1 on failure
+ * 
+ * @note The caller must close the returned descriptor
+ */
+int clone_file(const char *src_path, const char *dst_path);
+
+/**
+ * @brief Output file whose previous contents survive until the new ones are complete
+ */
+typedef struct {
+    int fd;             /**< Descriptor to write the new contents to */
+    char *path;         /**< File that receives the contents (symlinks resolved) */
+    char *temp_path;    /**< Sibling renamed over path on commit, NULL when written in place */
+} OutputFile;
+
+/**
+ * @brief Opens an output that only replaces path on output_file_commit()
+ * 
+ * Regular files (existing or not) are written to a temporary file in the same
+ * directory, created with the mode the destination would have (the existing
+ * file's mode, or 0666 minus the umask). FIFOs, devices and descriptors passed
+ * by name (/proc/self/fd/N, /dev/fd/N) cannot be replaced, so they are opened
+ * and truncated in place as before.
+ * 
+ * @param path Destination path
+ * @param out Output to initialize
+ * 
+ * @return 0 on success, -1 on failure (out->fd is -1)
+ */
+int output_file_open(const char *path, OutputFile *out);
+
+/**
+ * @brief Closes the output and moves the new contents into place
+ * 
+ * @return 0 on success, -1 if the output could not be closed or renamed (the
+ *         temporary file is removed and the destination is left untouched)
+ */
+int output_file_commit(OutputFile *out);
+
+/**
+ * @brief Closes the output and removes the temporary file, leaving the destination untouched
+ * 
+ * @note Safe to call on an output that failed to open or was already committed
+ */
+void output_file_discard(OutputFile *out);
+
 #endif // FILE_MANAGEMENT_H
@@ -2,14 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "../../bmp_handler/bmp_handler.h"
 #include "../../common/bmp_image.h"
 #include "../../lsb1/lsb1.h"
 #include "../../lsb4/lsb4.h"
 #include "../../lsbi/lsbi.h"
-
-#define PATTERN_MAP_SIZE 4
+#include "../../bmp_handler/bmp_stream.h"
+#include "../../bmp_handler/bmp_cache.h"
+#include "../../steg_stream/steg_stream.h"
 #include "../file_management/file_management.h"
+#include "../payload_source/payload_source.h"
+#include "../thread_pool/thread_pool.h"
+#include "../chunk_ring/chunk_ring.h"
 #include "../translator/translator.h"
 #include "../../encryption_manager/encryption_manager.h"
 #include "operations.h"
@@ -28,412 +36,1394 @@ static int convert_bmp_to_bmpimage(const Bmp *bmp, BMPImage *bmpimg) {
     return 0;
 }
 
-OperationsResult perform_embed(const stegobmp_config_t *config, const Bmp *bmp)
+typedef struct {
+    PayloadSource source;
+    size_t input_length;
+    char extension_buffer[64];
+    uint8_t size_header[4];
+    size_t unencrypted_payload_length; // tamaño + datos + extension
+    uint8_t plaintext_header[4];       // tamaño del archivo, delante de los datos al encriptar
+    struct iovec plaintext[3];         // tamaño + datos + extension, sin armar el bloque
+    bool encrypt_inline;               // el cifrado se produce por bloques mientras se oculta
+    EncryptStream *stream;             // cifrador con la clave ya derivada (solo en línea)
+    uint8_t *encrypted_data;
+    StegSegment segments[3];           // lo que se oculta, en orden y sin copiar
+    size_t segment_count;
+    size_t final_payload_length;
+} embed_payload_t;
+
+static void free_embed_payload(embed_payload_t *payload)
 {
-    uint8_t *input_buffer = NULL;
-    size_t input_length = 0;
-    
-    // Read input file to embed
-    if (read_file(config->in_file, &input_buffer, &input_length) != 0)
+    free(payload->encrypted_data);
+    encrypt_stream_free(payload->stream);
+    payload_source_close(&payload->source);
+    memset(payload, 0, sizeof(*payload));
+}
+
+static void add_segment(embed_payload_t *payload, const uint8_t *data, size_t length)
+{
+    payload->segments[payload->segment_count].data = data;
+    payload->segments[payload->segment_count].length = length;
+    payload->segment_count++;
+    payload->final_payload_length += length;
+}
+
+// Extension que se guarda con el payload; devuelve su largo con el '\0'
+static size_t payload_extension(const stegobmp_config_t *config, char *buffer, size_t size)
+{
+    // -ext manda (entrada por stdin o por descriptor); si no, la extension sale del nombre
+    const char *extension_dot_ptr = config->extension ? config->extension : strrchr(config->in_file, '.');
+
+    if (extension_dot_ptr)
+        snprintf(buffer, size, "%s", extension_dot_ptr);
+    else
+        snprintf(buffer, size, ".bin");
+
+    return strlen(buffer) + 1;
+}
+
+// Largo del bloque a ocultar a partir del tamaño del archivo, sin leerlo ni encriptarlo (0 si el cifrado no existe)
+static size_t embed_payload_length(const stegobmp_config_t *config, size_t input_length, size_t extension_length)
+{
+    size_t plaintext_length = 4 + input_length + extension_length;
+
+    if (!is_encryption_enabled(config))
+        return plaintext_length;
+
+    size_t cipher_length = encrypted_length(config, plaintext_length);
+    return cipher_length ? 4 + cipher_length : 0;
+}
+
+// Arma el bloque a ocultar: tamaño + datos + extension, encriptado si corresponde
+static OperationsResult build_embed_payload(const stegobmp_config_t *config, embed_payload_t *payload)
+{
+    memset(payload, 0, sizeof(*payload));
+
+    // Archivo a ocultar: mapeado si es regular, leído por bloques si es un pipe o stdin ("-")
+    if (payload_source_open(config->in_file, &payload->source) != 0)
     {
         fprintf(stderr, "Error: No pude leer archivo de entrada '%s'\n", config->in_file);
         return OPS_INPUT_READ_FAILED;
     }
 
-    const char *extension_dot_ptr = strrchr(config->in_file, '.');
-    char extension_buffer[64];
+    payload->input_length = payload->source.length;
 
-    if (extension_dot_ptr)
-        snprintf(extension_buffer, sizeof(extension_buffer), "%s", extension_dot_ptr);
-    else
-        snprintf(extension_buffer, sizeof(extension_buffer), ".bin");
+    if (payload->input_length > UINT32_MAX)
+    {
+        fprintf(stderr, "Error: Archivo de entrada demasiado grande (%zu bytes)\n", payload->input_length);
+        free_embed_payload(payload);
+        return OPS_INPUT_READ_FAILED;
+    }
 
-    size_t extension_length = strlen(extension_buffer) + 1; // include '\0'
+    size_t extension_length = payload_extension(config, payload->extension_buffer, sizeof(payload->extension_buffer));
 
-    size_t unencrypted_payload_length = 4 + input_length + extension_length;
-    uint8_t *unencrypted_payload = (uint8_t *)malloc(unencrypted_payload_length);
+    payload->unencrypted_payload_length = 4 + payload->input_length + extension_length;
 
-    if (!unencrypted_payload)
+    if (!is_encryption_enabled(config))
     {
-        fprintf(stderr, "Error: No pude asignar memoria para payload\n");
-        free(input_buffer);
-        return OPS_PAYLOAD_ALLOC_FAILED;
+        u32_to_be((uint32_t)payload->input_length, payload->size_header);
+        add_segment(payload, payload->size_header, 4);
+        add_segment(payload, payload->source.data, payload->input_length);
+        add_segment(payload, (const uint8_t *)payload->extension_buffer, extension_length);
+        return OPS_OK;
     }
 
-    u32_to_be((uint32_t)input_length, unencrypted_payload);
-    memcpy(unencrypted_payload + 4, input_buffer, input_length);
-    memcpy(unencrypted_payload + 4 + input_length, extension_buffer, extension_length);
+    // Se cifra tamaño + datos + extension directo desde donde están, sin armar el bloque
+    u32_to_be((uint32_t)payload->input_length, payload->plaintext_header);
 
-    uint8_t *final_payload = NULL;
-    size_t final_payload_length = 0;
-    bool needs_free_final = false;
+    payload->plaintext[0].iov_base = payload->plaintext_header;
+    payload->plaintext[0].iov_len = 4;
+    payload->plaintext[1].iov_base = (void *)payload->source.data;
+    payload->plaintext[1].iov_len = payload->input_length;
+    payload->plaintext[2].iov_base = payload->extension_buffer;
+    payload->plaintext[2].iov_len = extension_length;
 
-    if (is_encryption_enabled(config))
-    {
-        uint8_t *encrypted_data = NULL;
-        size_t encrypted_length = 0;
+    size_t encrypted_size = 0;
 
-        printf("Encriptando con ");
-        char enc_desc[64];
-        printf("%s...\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
+    printf("Encriptando con ");
+    char enc_desc[64];
+    printf("%s...\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
 
-        if (encrypt_data(config, unencrypted_payload, unencrypted_payload_length,
-                        &encrypted_data, &encrypted_length) != 0)
+    if (config->steg_method != STEG_LSBI)
+    {
+        // El largo del cifrado se conoce de antemano: se oculta la cabecera y el
+        // cifrado se inserta a medida que se produce (ver embed_encrypted_inline)
+        encrypted_size = encrypted_length(config, payload->unencrypted_payload_length);
+        if (encrypted_size == 0 || encrypted_size > UINT32_MAX)
         {
             fprintf(stderr, "Error: Fallo la encriptacion\n");
-            free(unencrypted_payload);
-            free(input_buffer);
+            free_embed_payload(payload);
             return OPS_ENCRYPTION_FAILED;
         }
 
-        final_payload_length = 4 + encrypted_length;
-        final_payload = (uint8_t *)malloc(final_payload_length);
-        
-        if (!final_payload)
+        // La clave se deriva ahora, antes de tocar la salida (y en paralelo con la carga del portador)
+        payload->stream = encrypt_stream_new(config);
+        if (payload->stream == NULL)
         {
-            fprintf(stderr, "Error: No pude asignar memoria para payload final\n");
-            free(encrypted_data);
-            free(unencrypted_payload);
-            free(input_buffer);
-            return OPS_PAYLOAD_ALLOC_FAILED;
+            fprintf(stderr, "Error: Fallo la encriptacion\n");
+            free_embed_payload(payload);
+            return OPS_ENCRYPTION_FAILED;
         }
 
-        u32_to_be((uint32_t)encrypted_length, final_payload);
-        memcpy(final_payload + 4, encrypted_data, encrypted_length);
-
-        free(encrypted_data);
-        needs_free_final = true;
-        
-        printf("Payload: %zu bytes -> %zu bytes encriptados (con padding)\n", 
-               unencrypted_payload_length, encrypted_length);
+        payload->encrypt_inline = true;
+        payload->final_payload_length = encrypted_size;
     }
     else
     {
-        final_payload = unencrypted_payload;
-        final_payload_length = unencrypted_payload_length;
-        needs_free_final = false;
+        // LSBI arma el pattern map sobre todo el bloque: necesita el cifrado completo
+        if (encrypt_iov(config, payload->plaintext, 3, &payload->encrypted_data, &encrypted_size) != 0)
+        {
+            fprintf(stderr, "Error: Fallo la encriptacion\n");
+            free_embed_payload(payload);
+            return OPS_ENCRYPTION_FAILED;
+        }
     }
 
-    BMPImage bmpimg;
-    if (convert_bmp_to_bmpimage(bmp, &bmpimg) != 0) {
-        fprintf(stderr, "Error: Fallo conversion BMP\n");
-        if (needs_free_final) free(final_payload);
-        free(unencrypted_payload);
-        free(input_buffer);
-        return OPS_EMBED_FAILED;
+    // Se ocultan el tamaño del cifrado y el cifrado tal cual
+    u32_to_be((uint32_t)encrypted_size, payload->size_header);
+    add_segment(payload, payload->size_header, 4);
+    if (!payload->encrypt_inline)
+        add_segment(payload, payload->encrypted_data, encrypted_size);
+
+    printf("Payload: %zu bytes -> %zu bytes encriptados (con padding)\n", 
+           payload->unencrypted_payload_length, encrypted_size);
+
+    return OPS_OK;
+}
+
+// Resultado de write_payload() cuando falla el cifrado (los demás son los de steg_writer_write())
+#define EMBED_ENCRYPT_FAILED (-7)
+
+typedef struct {
+    const embed_payload_t *payload;
+    EncryptStream *stream;
+    ChunkRing ring;
+} encrypt_pipeline_t;
+
+// Productor: cifra el texto plano por bloques y llena los slots del anillo
+static void *encrypt_producer(void *arg)
+{
+    encrypt_pipeline_t *pipeline = (encrypt_pipeline_t *)arg;
+    ChunkRing *ring = &pipeline->ring;
+    size_t block_size = encrypt_stream_block_size(pipeline->stream);
+    uint8_t *slot = NULL;
+    size_t used = 0;
+    size_t written = 0;
+    int status = 0;
+
+    for (size_t i = 0; i < 3 && status == 0; i++)
+    {
+        const uint8_t *in = (const uint8_t *)pipeline->payload->plaintext[i].iov_base;
+        size_t left = pipeline->payload->plaintext[i].iov_len;
+
+        while (left > 0 && status == 0)
+        {
+            if (slot == NULL && (slot = chunk_ring_acquire(ring)) == NULL)
+            {
+                status = -1;
+                break;
+            }
+
+            // Cada update puede devolver hasta un bloque más de lo que recibe
+            size_t take = ring->slot_size - used - block_size;
+            if (take > left)
+                take = left;
+
+            if (encrypt_stream_update(pipeline->stream, in, take, slot + used, &written) != 0)
+            {
+                status = -1;
+                break;
+            }
+
+            used += written;
+            in += take;
+            left -= take;
+
+            if (ring->slot_size - used <= block_size)
+            {
+                chunk_ring_commit(ring, used);
+                slot = NULL;
+                used = 0;
+            }
+        }
     }
 
-    const char *steg_method_name = "";
-    size_t pixel_bytes_per_data_byte = 0;
-    size_t num_bits = final_payload_length * 8;
+    if (status == 0 && slot == NULL && (slot = chunk_ring_acquire(ring)) == NULL)
+        status = -1;
+
+    if (status == 0 && encrypt_stream_final(pipeline->stream, slot + used, &written) != 0)
+        status = -1;
+
+    if (status == 0)
+        chunk_ring_commit(ring, used + written);
+
+    chunk_ring_close(ring, status);
+    return NULL;
+}
+
+/*
+ * Cifra e inserta a la vez: un hilo cifra hacia un anillo de buffers fijos
+ * mientras este hilo oculta cada bloque cifrado a continuación del anterior.
+ * La memoria usada es la del anillo, sin importar el tamaño del payload.
+ */
+static int embed_encrypted_inline(const embed_payload_t *payload, StegWriter *writer)
+{
+    encrypt_pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.payload = payload;
+    pipeline.stream = payload->stream;
+
+    if (chunk_ring_init(&pipeline.ring, CHUNK_RING_DEFAULT_SLOTS, CHUNK_RING_DEFAULT_SLOT_SIZE) != 0)
+        return -2;
 
-    switch (config->steg_method)
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, encrypt_producer, &pipeline) != 0)
     {
-        case STEG_LSB1:
-            pixel_bytes_per_data_byte = 8;
-            steg_method_name = "LSB1";
-            break;
-        case STEG_LSB4:
-            pixel_bytes_per_data_byte = 2; 
-            steg_method_name = "LSB4";
-            break;
-        case STEG_LSBI:
-            pixel_bytes_per_data_byte = 2;
-            steg_method_name = "LSBI";
+        chunk_ring_destroy(&pipeline.ring);
+        return -2;
+    }
+
+    int rc = 0;
+    size_t start = writer->written;
+    const uint8_t *chunk;
+    size_t chunk_length;
+
+    while ((chunk = chunk_ring_peek(&pipeline.ring, &chunk_length)) != NULL)
+    {
+        StegSegment segment = { chunk, chunk_length };
+        rc = chunk_length > 0 ? steg_writer_write(writer, &segment, 1) : 0;
+        chunk_ring_release(&pipeline.ring);
+
+        if (rc != 0)
+        {
+            chunk_ring_abort(&pipeline.ring);
             break;
-        default:
-            fprintf(stderr, "Error: Metodo de esteganografia invalido: %d\n", config->steg_method);
-            if (needs_free_final) free(final_payload);
-            free(unencrypted_payload);
-            free(input_buffer);
-            return OPS_INVALID_STEG_METHOD;
+        }
     }
 
-    size_t capacity_bytes = bmp->pixelsSize / pixel_bytes_per_data_byte;
-    
-    if (final_payload_length > capacity_bytes)
+    pthread_join(producer, NULL);
+
+    if (rc == 0 && (pipeline.ring.status != 0 || writer->written - start != payload->final_payload_length - 4))
+        rc = EMBED_ENCRYPT_FAILED;
+
+    chunk_ring_destroy(&pipeline.ring);
+    return rc;
+}
+
+// Oculta los segmentos del payload y, si el cifrado va en línea, el cifrado detrás
+static int write_payload(const embed_payload_t *payload, StegWriter *writer)
+{
+    int rc = steg_writer_write(writer, payload->segments, payload->segment_count);
+
+    if (rc == 0 && payload->encrypt_inline)
+        rc = embed_encrypted_inline(payload, writer);
+
+    return rc;
+}
+
+// Compara contra la capacidad exacta del método: solo cuentan los componentes de píxeles, nunca el padding
+// (bmp_validate_headers ya garantiza que las filas entran en los datos de píxeles)
+static OperationsResult check_embed_capacity(const stegobmp_config_t *config, size_t width, size_t height,
+                                             size_t payload_length)
+{
+    // Con -steg auto alcanza con que entre en el método de mayor capacidad
+    steg_method_t method = config->steg_method == STEG_AUTO ? STEG_LSB8 : config->steg_method;
+    const char *steg_method_name = steg_method_to_string(method);
+
+    if (method == STEG_NONE)
+    {
+        fprintf(stderr, "Error: Metodo de esteganografia invalido: %d\n", config->steg_method);
+        return OPS_INVALID_STEG_METHOD;
+    }
+
+    size_t capacity_bytes = steg_capacity_bytes(method, width, height);
+
+    if (payload_length > capacity_bytes)
     {
         fprintf(stderr, "Error: Capacidad insuficiente en BMP.\n");
-        fprintf(stderr, "       Necesitas: %zu bytes\n", final_payload_length);
+        fprintf(stderr, "       Necesitas: %zu bytes\n", payload_length);
         fprintf(stderr, "       Capacidad maxima (%s): %zu bytes\n", steg_method_name, capacity_bytes);
-        if (needs_free_final) free(final_payload);
-        free(unencrypted_payload);
-        free(input_buffer);
         return OPS_CAPACITY_INSUFFICIENT;
     }
 
-    printf("Incrustando con %s...\n", steg_method_name);
-    size_t offset = 0;
-    int embed_result = 0;
-    
-    switch (config->steg_method)
+    return OPS_OK;
+}
+
+/*
+ * Verificación anticipada: con el tamaño del archivo (stat) y las cabeceras del
+ * portador (del cache si ya está cargado) ya se sabe si el payload entra, antes
+ * de leer el archivo, derivar la clave o encriptar. Con stdin o un FIFO el
+ * tamaño no se conoce y la verificación queda para después de armar el payload.
+ */
+static OperationsResult precheck_embed_capacity(const stegobmp_config_t *config)
+{
+    Bmp headers;
+    if (bmp_cache_read_headers(config->carrier_cache, config->carrier_file, &headers) != 0)
     {
-        case STEG_LSB1:
-            embed_result = lsb1_embed(&bmpimg, final_payload, num_bits, &offset);
-            break;
-        case STEG_LSB4:
-            embed_result = lsb4_embed(&bmpimg, final_payload, num_bits, &offset);
-            break;
-        case STEG_LSBI:
-            embed_result = lsbi_embed(&bmpimg, final_payload, num_bits, &offset);
-            break;
-        default:
-            fprintf(stderr, "Error: Metodo de esteganografia invalido: %d\n", config->steg_method);
-            if (needs_free_final) free(final_payload);
-            free(unencrypted_payload);
-            free(input_buffer);
-            return OPS_EMBED_FAILED;
+        fprintf(stderr, "Error leyendo BMP (24bpp sin compresion requerido)\n");
+        return OPS_CARRIER_READ_FAILED;
     }
-    
-    if (embed_result != 0)
+
+    struct stat st;
+    if (strcmp(config->in_file, "-") == 0 || stat(config->in_file, &st) != 0 || !S_ISREG(st.st_mode) ||
+        (uint64_t)st.st_size > UINT32_MAX)
+        return OPS_OK;
+
+    char extension[64];
+    size_t extension_length = payload_extension(config, extension, sizeof(extension));
+    size_t payload_length = embed_payload_length(config, (size_t)st.st_size, extension_length);
+
+    // Algoritmo/modo sin soporte: lo informa el armado del payload
+    if (payload_length == 0)
+        return OPS_OK;
+
+    BMPImage image;
+    convert_bmp_to_bmpimage(&headers, &image);
+    return check_embed_capacity(config, image.width, image.height, payload_length);
+}
+
+// LSBn en orden de distorsión: el error cuadrático medio por bit oculto crece con n
+static const steg_method_t lsbn_methods[] = {
+    STEG_LSB1, STEG_LSB2, STEG_LSB3, STEG_LSB4, STEG_LSB5, STEG_LSB6, STEG_LSB7, STEG_LSB8
+};
+
+// Componentes que se espera modificar con LSBn: cada uno cambia salvo que sus n bits ya coincidan
+static size_t lsbn_expected_changes(unsigned n, size_t payload_length)
+{
+    size_t components = (payload_length * 8 + n - 1) / n;
+    return components - (components >> n);
+}
+
+// Donde se oculta: el portador en memoria o el stream con su descriptor de salida
+typedef struct {
+    BMPImage *image;
+    const BmpStream *stream;
+    int out_fd;
+    size_t band_size;
+    ThreadPool *pool;
+} embed_target_t;
+
+static int open_embed_writer(StegWriter *writer, const embed_target_t *target, steg_method_t method)
+{
+    if (target->stream != NULL)
+        return steg_writer_open_stream(writer, target->stream, target->out_fd, method, target->band_size, target->pool);
+    return steg_writer_open_memory(writer, target->image, method, target->pool);
+}
+
+/*
+ * -steg auto: el método que menos distorsiona entre los que alcanzan. LSBI
+ * solo toca el bit menos significativo, así que gana si cambia menos
+ * componentes que LSB1 (la mitad de los bits, en promedio); la cuenta sale de
+ * la pasada de histograma de LSBI sobre este portador, sin modificarlo. Un
+ * payload cifrado es ruido uniforme y se cifra en línea, así que va directo a
+ * LSBn. Deja el writer abierto con el método elegido (-3 si no entra en ninguno).
+ */
+static int open_auto_writer(const stegobmp_config_t *config, const embed_payload_t *payload,
+                            const embed_target_t *target, size_t width, size_t height,
+                            StegWriter *writer, steg_method_t *method)
+{
+    size_t length = payload->final_payload_length;
+    size_t lsb1_changes = lsbn_expected_changes(1, length);
+
+    if (!is_encryption_enabled(config) && length <= steg_capacity_bytes(STEG_LSBI, width, height))
     {
-        fprintf(stderr, "Error: Fallo embed %s\n", steg_method_name);
-        if (needs_free_final) free(final_payload);
-        free(unencrypted_payload);
-        free(input_buffer);
-        return OPS_EMBED_FAILED;
+        size_t lsbi_changes = 0;
+        int rc = open_embed_writer(writer, target, STEG_LSBI);
+
+        if (rc != 0)
+            return rc;
+
+        rc = steg_writer_estimate_lsbi(writer, payload->segments, payload->segment_count, &lsbi_changes);
+        if (rc == 0 && lsbi_changes < lsb1_changes)
+        {
+            printf("Metodo automatico: LSBI, %zu componentes modificados (LSB1: ~%zu)\n", lsbi_changes, lsb1_changes);
+            *method = STEG_LSBI;
+            return 0;
+        }
+
+        steg_writer_close(writer);
+        if (rc != 0)
+            return rc;
     }
-    
-    if (bmp_write(config->out_file, bmp) != 0)
+
+    for (size_t i = 0; i < sizeof(lsbn_methods) / sizeof(lsbn_methods[0]); i++)
     {
-        fprintf(stderr, "Error: No pude escribir BMP de salida '%s'\n", config->out_file);
-        if (needs_free_final) free(final_payload);
-        free(unencrypted_payload);
-        free(input_buffer);
-        return OPS_BMP_WRITE_FAILED;
+        if (length > steg_capacity_bytes(lsbn_methods[i], width, height))
+            continue;
+
+        unsigned n = steg_method_lsb_bits(lsbn_methods[i]);
+        printf("Metodo automatico: %s, ~%zu componentes modificados\n", steg_method_to_string(lsbn_methods[i]),
+               lsbn_expected_changes(n, length));
+        *method = lsbn_methods[i];
+        return open_embed_writer(writer, target, *method);
     }
 
-    if (needs_free_final) free(final_payload);
-    free(unencrypted_payload);
-    free(input_buffer);
-    
+    return -3;
+}
+
+// Abre el writer con el método pedido o, con -steg auto, con el elegido para este portador y payload
+static int open_payload_writer(const stegobmp_config_t *config, const embed_payload_t *payload,
+                               const embed_target_t *target, size_t width, size_t height,
+                               StegWriter *writer, steg_method_t *method)
+{
+    if (config->steg_method == STEG_AUTO)
+        return open_auto_writer(config, payload, target, width, height, writer, method);
+
+    *method = config->steg_method;
+    return open_embed_writer(writer, target, *method);
+}
+
+static void print_embed_summary(const stegobmp_config_t *config, const embed_payload_t *payload)
+{
+    const char *steg_method_name = steg_method_to_string(config->steg_method);
+
     if (is_encryption_enabled(config))
     {
         printf("\n=== EXITO ===\n");
-        printf("Archivo: '%s' (%zu bytes)\n", config->in_file, input_length);
+        printf("Archivo: '%s' (%zu bytes)\n", config->in_file, payload->input_length);
         printf("Encriptado y oculto en: '%s'\n", config->out_file);
-        printf("Extension: %s\n", extension_buffer);
+        printf("Extension: %s\n", payload->extension_buffer);
         printf("Metodo: %s\n", steg_method_name);
         char enc_desc[64];
         printf("Encriptacion: %s\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
-        printf("Total incrustado: %zu bytes\n", final_payload_length);
+        printf("Total incrustado: %zu bytes\n", payload->final_payload_length);
     }
     else
     {
         printf("\n=== EXITO ===\n");
-        printf("Archivo: '%s' (%zu bytes)\n", config->in_file, input_length);
+        printf("Archivo: '%s' (%zu bytes)\n", config->in_file, payload->input_length);
         printf("Oculto en: '%s'\n", config->out_file);
-        printf("Extension: %s\n", extension_buffer);
+        printf("Extension: %s\n", payload->extension_buffer);
         printf("Metodo: %s\n", steg_method_name);
-        printf("Total incrustado: %zu bytes (incluye tamaño y extension)\n", final_payload_length);
+        printf("Total incrustado: %zu bytes (incluye tamaño y extension)\n", payload->final_payload_length);
     }
-    
-    return OPS_OK;
 }
 
-OperationsResult perform_extract(const stegobmp_config_t *config, const Bmp *bmp)
+// Escribe la salida según -delta/-inplace: en esos modos solo las filas hasta el último componente usado
+static int write_embed_output(const stegobmp_config_t *config, const Bmp *bmp, const BMPImage *bmpimg, size_t components_used)
+{
+    size_t components_per_row = bmpimg->width * 3;
+    size_t row_size = (components_per_row + 3) & ~(size_t)3;
+    size_t end = components_per_row ? (components_used + components_per_row - 1) / components_per_row * row_size : 0;
+
+    if (end > bmp->pixelsSize)
+        end = bmp->pixelsSize;
+
+    switch (config->output_mode)
+    {
+        case OUTPUT_DELTA:
+            return bmp_write_delta(config->out_file, config->carrier_file, bmp, 0, end);
+        case OUTPUT_INPLACE:
+            return bmp_patch(config->carrier_file, bmp, 0, end);
+        default:
+            return bmp_write(config->out_file, bmp);
+    }
+}
+
+// Oculta un payload ya armado en un portador cargado en memoria y escribe la salida; libera el payload
+static OperationsResult embed_loaded(const stegobmp_config_t *config, const Bmp *bmp, embed_payload_t *payload)
 {
     BMPImage bmpimg;
     if (convert_bmp_to_bmpimage(bmp, &bmpimg) != 0) {
         fprintf(stderr, "Error: Fallo conversion BMP\n");
-        return OPS_EXTRACT_SIZE_FAILED;
+        free_embed_payload(payload);
+        return OPS_EMBED_FAILED;
+    }
+
+    OperationsResult rc = check_embed_capacity(config, bmpimg.width, bmpimg.height, payload->final_payload_length);
+    if (rc != OPS_OK)
+    {
+        free_embed_payload(payload);
+        return rc;
     }
 
-    const char *steg_method_name = "";
-    uint8_t pattern_map = 0;
     size_t offset = 0;
+    ThreadPool *pool = thread_pool_create(config->threads);
+    embed_target_t target = { &bmpimg, NULL, -1, 0, pool };
+    stegobmp_config_t resolved = *config;
+    StegWriter writer;
+    int embed_result = open_payload_writer(config, payload, &target, bmpimg.width, bmpimg.height, &writer,
+                                           &resolved.steg_method);
+    const char *steg_method_name = steg_method_to_string(resolved.steg_method);
 
-    switch (config->steg_method)
+    if (embed_result == 0)
     {
-        case STEG_LSB1:
-            steg_method_name = "LSB1";
-            break;
-        case STEG_LSB4:
-            steg_method_name = "LSB4";
-            break;
-        case STEG_LSBI:
-            steg_method_name = "LSBI";
-            if (lsb1_extract(&bmpimg, PATTERN_MAP_SIZE, &pattern_map, &offset) != 0) {
-                fprintf(stderr, "Error: Fallo al extraer pattern_map con LSB1\n");
-                return OPS_EXTRACT_SIZE_FAILED;
+        printf("Incrustando con %s...\n", steg_method_name);
+        embed_result = write_payload(payload, &writer);
+        offset = steg_writer_components_used(&writer);
+        steg_writer_close(&writer);
+    }
+    thread_pool_destroy(pool);
+
+    if (embed_result == EMBED_ENCRYPT_FAILED)
+    {
+        fprintf(stderr, "Error: Fallo la encriptacion\n");
+        free_embed_payload(payload);
+        return OPS_ENCRYPTION_FAILED;
+    }
+
+    if (embed_result == -3)
+    {
+        fprintf(stderr, "Error: Capacidad insuficiente en BMP (%s)\n", steg_method_name);
+        free_embed_payload(payload);
+        return OPS_CAPACITY_INSUFFICIENT;
+    }
+
+    if (embed_result != 0)
+    {
+        fprintf(stderr, "Error: Fallo embed %s\n", steg_method_name);
+        free_embed_payload(payload);
+        return OPS_EMBED_FAILED;
+    }
+    
+    if (write_embed_output(config, bmp, &bmpimg, offset) != 0)
+    {
+        fprintf(stderr, "Error: No pude escribir BMP de salida '%s'\n", config->out_file);
+        free_embed_payload(payload);
+        return OPS_BMP_WRITE_FAILED;
+    }
+
+    print_embed_summary(&resolved, payload);
+    free_embed_payload(payload);
+    return OPS_OK;
+}
+
+// Carga del portador en su propio hilo: abre y valida el BMP mientras otro hilo arma el payload
+typedef struct {
+    const stegobmp_config_t *config;
+    bool streaming;     // Solo cabeceras (BmpStream) o el portador completo (Bmp)
+    Bmp bmp;
+    BmpStream stream;
+    int result;
+} carrier_loader_t;
+
+static void *load_carrier(void *arg)
+{
+    carrier_loader_t *loader = (carrier_loader_t *)arg;
+
+    if (loader->streaming)
+    {
+        loader->result = bmp_stream_open(loader->config->carrier_file, &loader->stream);
+        return NULL;
+    }
+
+    // En -batch/-serve un portador repetido sale del cache sin tocar el disco
+    loader->result = bmp_cache_read(loader->config->carrier_cache, loader->config->carrier_file, &loader->bmp);
+
+    // La salida completa recorre todos los píxeles: se leen acá y no durante el embed
+    if (loader->result == 0 && loader->config->output_mode == OUTPUT_FULL)
+        bmp_prefetch(&loader->bmp);
+
+    return NULL;
+}
+
+/*
+ * Carga el portador y arma el payload a la vez: el I/O del portador y la
+ * lectura del archivo + PBKDF2 + encriptado son independientes, así que la
+ * latencia es la del más lento y no la suma. Se juntan antes de ocultar.
+ */
+static OperationsResult load_carrier_and_payload(const stegobmp_config_t *config, bool streaming,
+                                                 carrier_loader_t *loader, embed_payload_t *payload)
+{
+    memset(loader, 0, sizeof(*loader));
+    loader->config = config;
+    loader->streaming = streaming;
+
+    pthread_t thread;
+    bool threaded = pthread_create(&thread, NULL, load_carrier, loader) == 0;
+    if (!threaded)
+        load_carrier(loader);
+
+    OperationsResult rc = build_embed_payload(config, payload);
+
+    if (threaded)
+        pthread_join(thread, NULL);
+
+    if (loader->result != 0)
+    {
+        fprintf(stderr, "Error leyendo BMP (24bpp sin compresion requerido)\n");
+        if (rc == OPS_OK)
+            free_embed_payload(payload);
+        return OPS_CARRIER_READ_FAILED;
+    }
+
+    if (rc != OPS_OK)
+    {
+        if (loader->streaming)
+            bmp_stream_close(&loader->stream);
+        else
+            bmp_free(&loader->bmp);
+    }
+
+    return rc;
+}
+
+OperationsResult perform_embed_carrier(const stegobmp_config_t *config)
+{
+    carrier_loader_t loader;
+    embed_payload_t payload;
+    OperationsResult rc = precheck_embed_capacity(config);
+
+    if (rc == OPS_OK)
+        rc = load_carrier_and_payload(config, false, &loader, &payload);
+
+    if (rc != OPS_OK)
+        return rc;
+
+    rc = embed_loaded(config, &loader.bmp, &payload);
+    bmp_free(&loader.bmp);
+    return rc;
+}
+
+OperationsResult perform_embed_stream(const stegobmp_config_t *config)
+{
+    carrier_loader_t loader;
+    embed_payload_t payload;
+    OperationsResult rc = precheck_embed_capacity(config);
+
+    if (rc == OPS_OK)
+        rc = load_carrier_and_payload(config, true, &loader, &payload);
+
+    if (rc != OPS_OK)
+        return rc;
+
+    BmpStream carrier = loader.stream;
+
+    rc = check_embed_capacity(config, carrier.width, carrier.height, payload.final_payload_length);
+    if (rc != OPS_OK)
+    {
+        free_embed_payload(&payload);
+        bmp_stream_close(&carrier);
+        return rc;
+    }
+
+    size_t band_size = config->band_size ? config->band_size : STEG_STREAM_DEFAULT_BAND;
+    stegobmp_config_t resolved = *config;
+
+    // -delta parte de un clon del portador y -inplace del portador mismo: solo se escriben las filas usadas
+    int out_fd;
+    switch (config->output_mode)
+    {
+        case OUTPUT_DELTA:
+            out_fd = clone_file(config->carrier_file, config->out_file);
+            // El hueco antes de los píxeles queda como en la escritura completa
+            if (out_fd >= 0 && bmp_zero_gap(out_fd, carrier.fileHeader.bfOffBits) != 0)
+            {
+                close(out_fd);
+                out_fd = -1;
             }
             break;
+        case OUTPUT_INPLACE:
+            out_fd = open(config->carrier_file, O_WRONLY);
+            break;
         default:
-            fprintf(stderr, "Error: Metodo de esteganografia invalido\n");
-            return OPS_INVALID_STEG_METHOD;
+            out_fd = bmp_stream_create(config->out_file, &carrier);
+            break;
     }
-    
-    printf("Extrayendo con %s...\n", steg_method_name);
-    
-    uint8_t big_endian_size_header[4];
-    int extract_result = 0;
-    
-    switch (config->steg_method)
+
+    int stream_result = -4;
+    if (out_fd >= 0)
     {
-        case STEG_LSB1:
-            extract_result = lsb1_extract(&bmpimg, 32, big_endian_size_header, &offset);
+        ThreadPool *pool = thread_pool_create(config->threads);
+        embed_target_t target = { NULL, &carrier, out_fd, band_size, pool };
+        StegWriter writer;
+
+        stream_result = open_payload_writer(config, &payload, &target, carrier.width, carrier.height, &writer,
+                                            &resolved.steg_method);
+        if (stream_result == 0)
+        {
+            printf("Incrustando con %s (bandas de %zu bytes)...\n", steg_method_to_string(resolved.steg_method),
+                   band_size);
+            stream_result = write_payload(&payload, &writer);
+            if (stream_result == 0)
+                stream_result = steg_writer_finish(&writer, config->output_mode == OUTPUT_FULL);
+            steg_writer_close(&writer);
+        }
+        thread_pool_destroy(pool);
+        if (close(out_fd) != 0 && stream_result == 0)
+            stream_result = -4;
+    }
+    bmp_stream_close(&carrier);
+
+    const char *steg_method_name = steg_method_to_string(resolved.steg_method);
+    switch (stream_result)
+    {
+        case 0:
             break;
-        case STEG_LSB4:
-            extract_result = lsb4_extract(&bmpimg, 32, big_endian_size_header, &offset);
+        case -3:
+            fprintf(stderr, "Error: Capacidad insuficiente en BMP (%s)\n", steg_method_name);
+            free_embed_payload(&payload);
+            return OPS_CAPACITY_INSUFFICIENT;
+        case -4:
+            fprintf(stderr, "Error: No pude escribir BMP de salida '%s'\n", config->out_file);
+            free_embed_payload(&payload);
+            return OPS_BMP_WRITE_FAILED;
+        case EMBED_ENCRYPT_FAILED:
+            fprintf(stderr, "Error: Fallo la encriptacion\n");
+            free_embed_payload(&payload);
+            return OPS_ENCRYPTION_FAILED;
+        default:
+            fprintf(stderr, "Error: Fallo embed %s\n", steg_method_name);
+            free_embed_payload(&payload);
+            return OPS_EMBED_FAILED;
+    }
+
+    print_embed_summary(&resolved, &payload);
+    free_embed_payload(&payload);
+    return OPS_OK;
+}
+
+// Abre el lector sobre el portador; en LSBI ya deja leído el pattern_map
+static OperationsResult report_reader_open(const stegobmp_config_t *config, int open_result)
+{
+    if (open_result == 0)
+        return OPS_OK;
+
+    if (open_result == -1)
+    {
+        fprintf(stderr, "Error: Metodo de esteganografia invalido\n");
+        return OPS_INVALID_STEG_METHOD;
+    }
+
+    if (config->steg_method == STEG_LSBI)
+        fprintf(stderr, "Error: Fallo al extraer pattern_map con LSB1\n");
+    else
+        fprintf(stderr, "Error: No pude leer el BMP portador\n");
+    return OPS_EXTRACT_SIZE_FAILED;
+}
+
+// Bytes que se guardan después de los datos: la extension y, con cifrado, el padding
+#define EXTRACT_TAIL_MAX 128
+
+typedef struct {
+    StegReader *reader;
+    size_t length;
+    ChunkRing ring;
+} extract_pipeline_t;
+
+// Productor: extrae el bloque oculto por partes hacia los slots del anillo
+static void *extract_producer(void *arg)
+{
+    extract_pipeline_t *pipeline = (extract_pipeline_t *)arg;
+    ChunkRing *ring = &pipeline->ring;
+    size_t left = pipeline->length;
+    int status = 0;
+
+    while (left > 0)
+    {
+        uint8_t *slot = chunk_ring_acquire(ring);
+        if (slot == NULL)
+        {
+            status = -1;
             break;
-        case STEG_LSBI:
-            extract_result = lsbi_extract(&bmpimg, 32, big_endian_size_header, &offset, &pattern_map);
+        }
+
+        size_t take = left < ring->slot_size ? left : ring->slot_size;
+        status = steg_reader_read(pipeline->reader, slot, take);
+        if (status != 0)
             break;
-        default:
-            fprintf(stderr, "Error: Metodo de esteganografia invalido\n");
-            return OPS_EXTRACT_SIZE_FAILED;
+
+        chunk_ring_commit(ring, take);
+        left -= take;
     }
-    
-    if (extract_result != 0)
+
+    chunk_ring_close(ring, status);
+    return NULL;
+}
+
+/*
+ * Destino del bloque extraído: [tamaño][datos][extension\0] (más el padding
+ * con cifrado). El tamaño va en la cabecera o, con cifrado, en los primeros
+ * 4 bytes descifrados; los datos se escriben al archivo a medida que llegan y
+ * lo que sigue queda en tail, de donde sale la extension.
+ */
+typedef struct {
+    const char *path;
+    OutputFile output;               // fd -1 hasta conocer el tamaño real
+    size_t limit;                    // Bytes del bloque (cota para el tamaño real)
+    uint8_t header[4];
+    size_t header_length;
+    size_t data_size;
+    size_t data_left;
+    uint8_t tail[EXTRACT_TAIL_MAX];
+    size_t tail_length;
+    size_t received;
+} extract_sink_t;
+
+// Los datos van a un temporal junto a la salida: un -out existente no se toca hasta que la extracción termina bien
+static OperationsResult sink_open_output(extract_sink_t *sink)
+{
+    if (output_file_open(sink->path, &sink->output) != 0)
     {
-        fprintf(stderr, "Error: Fallo al extraer cabecera de tamaño con %s\n", steg_method_name);
-        return OPS_EXTRACT_SIZE_FAILED;
+        fprintf(stderr, "Error: No pude escribir archivo de salida '%s'\n", sink->path);
+        return OPS_OUTPUT_WRITE_FAILED;
     }
+    return OPS_OK;
+}
 
-    uint32_t data_size = be_to_u32(big_endian_size_header);
-    
-    printf("Tamaño del bloque: %u bytes\n", data_size);
+static OperationsResult sink_push(extract_sink_t *sink, const uint8_t *data, size_t length)
+{
+    sink->received += length;
 
-    size_t max_reasonable_size = bmp->pixelsSize;
-    if (data_size > max_reasonable_size) {
-        fprintf(stderr, "Error: Tamaño del bloque invalido (%u bytes) excede capacidad disponible (%zu bytes)\n", 
-                data_size, max_reasonable_size);
-        return OPS_EXTRACT_BLOCK_FAILED;
+    if (sink->header_length < 4)
+    {
+        size_t take = 4 - sink->header_length;
+        if (take > length)
+            take = length;
+
+        memcpy(sink->header + sink->header_length, data, take);
+        sink->header_length += take;
+        data += take;
+        length -= take;
+
+        if (sink->header_length < 4)
+            return OPS_OK;
+
+        sink->data_size = be_to_u32(sink->header);
+        sink->data_left = sink->data_size;
+
+        // Con password incorrecta el tamaño es basura: se corta antes de crear la salida
+        if (4 + sink->data_size > sink->limit)
+        {
+            fprintf(stderr, "Error: Datos desencriptados incompletos\n");
+            fprintf(stderr, "       Esperaba: %zu bytes, tengo: %zu bytes\n", 
+                    4 + sink->data_size, sink->limit);
+            return OPS_DECRYPTION_FAILED;
+        }
+
+        OperationsResult rc = sink_open_output(sink);
+        if (rc != OPS_OK)
+            return rc;
     }
-    
-    uint8_t *extracted_data = (uint8_t *)malloc(data_size);
-    if (!extracted_data)
+
+    size_t take = sink->data_left < length ? sink->data_left : length;
+    if (take > 0)
+    {
+        if (write_all(sink->output.fd, data, take) != 0)
+        {
+            fprintf(stderr, "Error: No pude escribir archivo de salida '%s'\n", sink->path);
+            return OPS_OUTPUT_WRITE_FAILED;
+        }
+        sink->data_left -= take;
+        data += take;
+        length -= take;
+    }
+
+    take = sizeof(sink->tail) - sink->tail_length;
+    if (take > length)
+        take = length;
+    memcpy(sink->tail + sink->tail_length, data, take);
+    sink->tail_length += take;
+
+    return OPS_OK;
+}
+
+static OperationsResult report_decrypt_failure(void)
+{
+    fprintf(stderr, "Error: Fallo la desencriptacion\n");
+    fprintf(stderr, "       (Verifica la password y los parametros)\n");
+    return OPS_DECRYPTION_FAILED;
+}
+
+/*
+ * Extrae, descifra y escribe a la vez: un hilo extrae el bloque hacia un anillo
+ * de buffers fijos mientras este hilo descifra cada parte y escribe los datos.
+ * La memoria usada es la del anillo, sin importar el tamaño del bloque.
+ */
+static OperationsResult extract_block(const stegobmp_config_t *config, StegReader *reader,
+                                      size_t length, extract_sink_t *sink)
+{
+    extract_pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.reader = reader;
+    pipeline.length = length;
+
+    DecryptStream *stream = NULL;
+    uint8_t *plaintext = NULL;
+
+    if (chunk_ring_init(&pipeline.ring, CHUNK_RING_DEFAULT_SLOTS, CHUNK_RING_DEFAULT_SLOT_SIZE) != 0)
     {
         fprintf(stderr, "Error: No pude asignar memoria para extraccion\n");
         return OPS_EXTRACT_ALLOC_FAILED;
     }
 
-    extract_result = 0;
-    switch (config->steg_method)
+    if (is_encryption_enabled(config))
     {
-        case STEG_LSB1:
-            extract_result = lsb1_extract(&bmpimg, data_size * 8, extracted_data, &offset);
-            break;
-        case STEG_LSB4:
-            extract_result = lsb4_extract(&bmpimg, data_size * 8, extracted_data, &offset);
-            break;
-        case STEG_LSBI:
-            extract_result = lsbi_extract(&bmpimg, data_size * 8, extracted_data, &offset, &pattern_map);
+        stream = decrypt_stream_new(config);
+        if (stream == NULL)
+        {
+            chunk_ring_destroy(&pipeline.ring);
+            return report_decrypt_failure();
+        }
+
+        plaintext = (uint8_t *)malloc(pipeline.ring.slot_size + decrypt_stream_block_size(stream));
+        if (plaintext == NULL)
+        {
+            fprintf(stderr, "Error: No pude asignar memoria para extraccion\n");
+            decrypt_stream_free(stream);
+            chunk_ring_destroy(&pipeline.ring);
+            return OPS_EXTRACT_ALLOC_FAILED;
+        }
+    }
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, extract_producer, &pipeline) != 0)
+    {
+        fprintf(stderr, "Error: No pude asignar memoria para extraccion\n");
+        free(plaintext);
+        decrypt_stream_free(stream);
+        chunk_ring_destroy(&pipeline.ring);
+        return OPS_EXTRACT_ALLOC_FAILED;
+    }
+
+    OperationsResult rc = OPS_OK;
+    const uint8_t *chunk;
+    size_t chunk_length;
+
+    while ((chunk = chunk_ring_peek(&pipeline.ring, &chunk_length)) != NULL)
+    {
+        if (stream == NULL)
+        {
+            rc = sink_push(sink, chunk, chunk_length);
+        }
+        else
+        {
+            size_t plaintext_length = 0;
+            if (decrypt_stream_update(stream, chunk, chunk_length, plaintext, &plaintext_length) != 0)
+                rc = report_decrypt_failure();
+            else
+                rc = sink_push(sink, plaintext, plaintext_length);
+        }
+        chunk_ring_release(&pipeline.ring);
+
+        if (rc != OPS_OK)
+        {
+            chunk_ring_abort(&pipeline.ring);
             break;
-        default:
-            fprintf(stderr, "Error: Metodo de esteganografia invalido\n");
-            free(extracted_data);
-            return OPS_EXTRACT_BLOCK_FAILED;
+        }
     }
 
-    if (extract_result != 0)
+    pthread_join(producer, NULL);
+
+    if (rc == OPS_OK && pipeline.ring.status != 0)
     {
         fprintf(stderr, "Error: Fallo al extraer bloque de datos\n");
-        free(extracted_data);
+        rc = OPS_EXTRACT_BLOCK_FAILED;
+    }
+
+    if (rc == OPS_OK && stream != NULL)
+    {
+        size_t plaintext_length = 0;
+        if (decrypt_stream_final(stream, plaintext, &plaintext_length) != 0)
+            rc = report_decrypt_failure();
+        else
+            rc = sink_push(sink, plaintext, plaintext_length);
+    }
+
+    free(plaintext);
+    decrypt_stream_free(stream);
+    chunk_ring_destroy(&pipeline.ring);
+    return rc;
+}
+
+static OperationsResult extract_with_reader(const stegobmp_config_t *config, StegReader *reader, size_t pixels_size)
+{
+    const char *steg_method_name = steg_method_to_string(config->steg_method);
+
+    printf("Extrayendo con %s...\n", steg_method_name);
+    
+    uint8_t big_endian_size_header[4];
+    
+    if (steg_reader_read(reader, big_endian_size_header, sizeof(big_endian_size_header)) != 0)
+    {
+        fprintf(stderr, "Error: Fallo al extraer cabecera de tamaño con %s\n", steg_method_name);
+        return OPS_EXTRACT_SIZE_FAILED;
+    }
+
+    uint32_t data_size = be_to_u32(big_endian_size_header);
+    
+    printf("Tamaño del bloque: %u bytes\n", data_size);
+
+    size_t max_reasonable_size = steg_reader_remaining(reader);
+    if (max_reasonable_size > pixels_size)
+        max_reasonable_size = pixels_size;
+
+    if (data_size > max_reasonable_size) {
+        fprintf(stderr, "Error: Tamaño del bloque invalido (%u bytes) excede capacidad disponible (%zu bytes)\n", 
+                data_size, max_reasonable_size);
         return OPS_EXTRACT_BLOCK_FAILED;
     }
 
-    if (is_encryption_enabled(config))
+    extract_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.path = config->out_file;
+    sink.output.fd = -1;
+    sink.limit = data_size;
+
+    char enc_desc[64];
+    bool encrypted = is_encryption_enabled(config);
+    OperationsResult rc = OPS_OK;
+
+    if (encrypted)
     {
         printf("Desencriptando con ");
-        char enc_desc[64];
         printf("%s...\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
-        
-        uint8_t *decrypted_data = NULL;
-        size_t decrypted_length = 0;
+    }
+    else
+    {
+        // Sin cifrado el tamaño real es el del bloque: la salida se crea ya
+        memcpy(sink.header, big_endian_size_header, 4);
+        sink.header_length = 4;
+        sink.data_size = data_size;
+        sink.data_left = data_size;
+        rc = sink_open_output(&sink);
+    }
 
-        if (decrypt_data(config, extracted_data, data_size,
-                        &decrypted_data, &decrypted_length) != 0)
-        {
-            fprintf(stderr, "Error: Fallo la desencriptacion\n");
-            fprintf(stderr, "       (Verifica la password y los parametros)\n");
-            free(extracted_data);
-            return OPS_DECRYPTION_FAILED;
-        }
+    // Solo se leen las filas que contienen el bloque
+    if (rc == OPS_OK)
+        rc = extract_block(config, reader, data_size, &sink);
 
-        printf("Desencriptado: %zu bytes\n", decrypted_length);
+    const char *extension_string = NULL;
+    char extension_buffer[16];
 
-        if (decrypted_length < 4)
+    if (rc == OPS_OK && encrypted)
+    {
+        printf("Desencriptado: %zu bytes\n", sink.received);
+
+        if (sink.header_length < 4)
         {
             fprintf(stderr, "Error: Datos desencriptados demasiado cortos\n");
-            free(decrypted_data);
-            free(extracted_data);
-            return OPS_DECRYPTION_FAILED;
+            rc = OPS_DECRYPTION_FAILED;
         }
-
-        uint32_t real_data_size = be_to_u32(decrypted_data);
-        
-        if (decrypted_length < 4 + real_data_size)
+        else if (sink.data_left > 0)
         {
             fprintf(stderr, "Error: Datos desencriptados incompletos\n");
-            fprintf(stderr, "       Esperaba: %u bytes, tengo: %zu bytes\n", 
-                    4 + real_data_size, decrypted_length);
-            free(decrypted_data);
-            free(extracted_data);
-            return OPS_DECRYPTION_FAILED;
+            fprintf(stderr, "       Esperaba: %zu bytes, tengo: %zu bytes\n", 
+                    4 + sink.data_size, sink.received);
+            rc = OPS_DECRYPTION_FAILED;
         }
-
-        uint8_t *file_data = decrypted_data + 4;
-        const char *extension_string_ptr = (const char *)(file_data + real_data_size);
-        
-        size_t max_ext_search = decrypted_length - 4 - real_data_size;
-        size_t extension_length = strnlen(extension_string_ptr, max_ext_search);
-
-        if (extension_length == max_ext_search)
+        else if (memchr(sink.tail, '\0', sink.tail_length) == NULL)
         {
             fprintf(stderr, "Error: No encontre terminador de extension\n");
-            free(decrypted_data);
-            free(extracted_data);
-            return OPS_EXTENSION_NOT_FOUND;
+            rc = OPS_EXTENSION_NOT_FOUND;
+        }
+        else
+        {
+            extension_string = (const char *)sink.tail;
         }
+    }
+    else if (rc == OPS_OK)
+    {
+        // La extension sigue a los datos: se lee byte a byte hasta el '\0' (maximo 16)
+        size_t extension_length = 0;
 
-        if (write_file(config->out_file, file_data, real_data_size) != 0)
+        for (; extension_length < sizeof(extension_buffer); extension_length++)
         {
-            fprintf(stderr, "Error: No pude escribir archivo de salida '%s'\n", config->out_file);
-            free(decrypted_data);
-            free(extracted_data);
-            return OPS_OUTPUT_WRITE_FAILED;
+            if (steg_reader_read(reader, (uint8_t *)&extension_buffer[extension_length], 1) != 0 ||
+                extension_buffer[extension_length] == '\0')
+                break;
         }
 
+        if (extension_length == sizeof(extension_buffer) || extension_buffer[extension_length] != '\0')
+        {
+            fprintf(stderr, "Error: No encontre terminador de extension\n");
+            rc = OPS_EXTENSION_NOT_FOUND;
+        }
+        else
+        {
+            extension_string = extension_buffer;
+        }
+    }
 
-        printf("\n=== EXITO ===\n");
-        printf("Archivo extraido: '%s' (%u bytes)\n", config->out_file, real_data_size);
-        printf("Extension recuperada: %s\n", extension_string_ptr);
-        printf("Metodo: %s\n", steg_method_name);
-        printf("Desencriptacion: %s\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
-        
-        free(decrypted_data);
+    if (rc != OPS_OK)
+    {
+        output_file_discard(&sink.output);
+        return rc;
     }
-    else
+
+    if (output_file_commit(&sink.output) != 0)
     {
+        fprintf(stderr, "Error: No pude escribir archivo de salida '%s'\n", config->out_file);
+        return OPS_OUTPUT_WRITE_FAILED;
+    }
+
+    printf("\n=== EXITO ===\n");
+    printf("Archivo extraido: '%s' (%zu bytes)\n", config->out_file, sink.data_size);
+    printf("Extension recuperada: %s\n", extension_string);
+    printf("Metodo: %s\n", steg_method_name);
+    if (encrypted)
+        printf("Desencriptacion: %s\n", get_encryption_description(config, enc_desc, sizeof(enc_desc)));
+
+    return OPS_OK;
+}
+
+// Candidatos de -steg auto al extraer: primero los métodos clásicos, que ganan los empates
+static const steg_method_t extract_auto_methods[] = {
+    STEG_LSB1, STEG_LSB4, STEG_LSBI, STEG_LSB2, STEG_LSB3, STEG_LSB5, STEG_LSB6, STEG_LSB7, STEG_LSB8
+};
+
+#define EXTRACT_AUTO_CANDIDATES (sizeof(extract_auto_methods) / sizeof(extract_auto_methods[0]))
+
+// Banda de cada sondeo: alcanza para la cabecera y la extension
+#define EXTRACT_PROBE_BAND (64u << 10)
+
+// Mayor bloque de cifrado que se descifra al sondear (AES: 16, 3DES: 8)
+#define EXTRACT_PROBE_BLOCK_MAX 32
 
-        
-        uint32_t real_data_size = data_size;
-        uint8_t *file_data = extracted_data;
-        const char *extension_string_ptr = (const char *)(file_data + real_data_size);
-        
-        size_t extension_length = strnlen(extension_string_ptr, 16);
+typedef struct {
+    const stegobmp_config_t *config;
+    const BmpStream *carrier;
+    steg_method_t method;
+    DecryptStream *decrypt;         // Copia del descifrador ya derivado (solo con cifrado)
+    uint32_t size;
+    int score;                      // 0: imposible, 1: plausible, 2: además extension con forma de extension
+} extract_probe_t;
 
-        if (extension_length == 16)
+/*
+ * Con cifrado se descifra solo el primer bloque: el tamaño del archivo que
+ * trae tiene que dar exactamente el largo del cifrado con alguna extension de
+ * 1 a 16 bytes (con el padding del modo).
+ */
+static bool plausible_cipher_block(extract_probe_t *probe, StegReader *reader)
+{
+    size_t block = decrypt_stream_block_size(probe->decrypt);
+    size_t take = block < 4 ? 4 : block;
+    uint8_t cipher[EXTRACT_PROBE_BLOCK_MAX];
+    uint8_t plain[2 * EXTRACT_PROBE_BLOCK_MAX];
+    size_t plain_length = 0;
+
+    if (probe->size < take || take > sizeof(cipher) || steg_reader_read(reader, cipher, take) != 0 ||
+        decrypt_stream_update(probe->decrypt, cipher, take, plain, &plain_length) != 0 || plain_length < 4)
+        return false;
+
+    size_t data_size = be_to_u32(plain);
+    for (size_t extension_length = 1; extension_length <= 16; extension_length++)
+        if (encrypted_length(probe->config, 4 + data_size + extension_length) == probe->size)
+            return true;
+    return false;
+}
+
+static bool looks_like_extension(const char *extension)
+{
+    if (extension[0] != '.')
+        return false;
+
+    for (const char *c = extension; *c; c++)
+        if (*c < 0x21 || *c > 0x7e)
+            return false;
+    return true;
+}
+
+/*
+ * Sondeo de un candidato: la cabecera de tamaño tiene que caber en la
+ * capacidad exacta y, sin cifrado, detrás de los datos tiene que haber una
+ * extension terminada en '\0' dentro de 16 bytes. Los datos se saltean sin
+ * leerlos, así que cada sondeo lee unos pocos KB del portador.
+ */
+static void probe_extract_method(void *arg, size_t index)
+{
+    extract_probe_t *probe = &((extract_probe_t *)arg)[index];
+    uint8_t header[4];
+    StegReader reader;
+
+    probe->score = 0;
+    if (steg_reader_open_stream(&reader, probe->carrier, probe->method, EXTRACT_PROBE_BAND, NULL) != 0)
+        return;
+
+    if (steg_reader_read(&reader, header, sizeof(header)) == 0)
+    {
+        probe->size = be_to_u32(header);
+
+        if (probe->size > steg_reader_remaining(&reader))
+            probe->score = 0;
+        else if (probe->decrypt != NULL)
+            probe->score = plausible_cipher_block(probe, &reader) ? 1 : 0;
+        else if (steg_reader_skip(&reader, probe->size) == 0)
         {
-            fprintf(stderr, "Error: No encontre terminador de extension\n");
-            free(extracted_data);
-            return OPS_EXTENSION_NOT_FOUND;
+            char extension[16];
+            size_t length = 0;
+
+            while (length < sizeof(extension) && steg_reader_read(&reader, (uint8_t *)&extension[length], 1) == 0 &&
+                   extension[length] != '\0')
+                length++;
+
+            if (length < sizeof(extension) && extension[length] == '\0')
+                probe->score = looks_like_extension(extension) ? 2 : 1;
         }
+    }
+
+    steg_reader_close(&reader);
+}
+
+/*
+ * -steg auto: sondea todos los candidatos a la vez sobre el mismo portador y
+ * se queda con el más plausible; solo ese se extrae completo.
+ */
+static OperationsResult detect_extract_method(const stegobmp_config_t *config, const BmpStream *carrier,
+                                              ThreadPool *pool, steg_method_t *method)
+{
+    extract_probe_t probes[EXTRACT_AUTO_CANDIDATES];
+    memset(probes, 0, sizeof(probes));
+
+    // La clave se deriva una sola vez; cada candidato descifra con su propia copia
+    DecryptStream *decrypt = NULL;
+    if (is_encryption_enabled(config) && (decrypt = decrypt_stream_new(config)) == NULL)
+        return report_decrypt_failure();
+
+    bool ready = true;
+    for (size_t i = 0; i < EXTRACT_AUTO_CANDIDATES; i++)
+    {
+        probes[i].config = config;
+        probes[i].carrier = carrier;
+        probes[i].method = extract_auto_methods[i];
+        if (decrypt != NULL && (probes[i].decrypt = decrypt_stream_dup(decrypt)) == NULL)
+            ready = false;
+    }
+
+    if (ready)
+        thread_pool_run(pool, probe_extract_method, probes, EXTRACT_AUTO_CANDIDATES);
+
+    for (size_t i = 0; i < EXTRACT_AUTO_CANDIDATES; i++)
+        decrypt_stream_free(probes[i].decrypt);
+    decrypt_stream_free(decrypt);
+
+    if (!ready)
+        return report_decrypt_failure();
+
+    const extract_probe_t *best = NULL;
+    size_t ties = 0;
 
-        if (write_file(config->out_file, file_data, real_data_size) != 0)
+    for (size_t i = 0; i < EXTRACT_AUTO_CANDIDATES; i++)
+    {
+        if (probes[i].score == 0)
+            continue;
+        if (best == NULL || probes[i].score > best->score)
         {
-            fprintf(stderr, "Error: No pude escribir archivo de salida '%s'\n", config->out_file);
-            free(extracted_data);
-            return OPS_OUTPUT_WRITE_FAILED;
+            best = &probes[i];
+            ties = 0;
         }
+        else if (probes[i].score == best->score)
+            ties++;
+    }
 
-        printf("\n=== EXITO ===\n");
-        printf("Archivo extraido: '%s' (%u bytes)\n", config->out_file, real_data_size);
-        printf("Extension recuperada: %s\n", extension_string_ptr);
-        printf("Metodo: %s\n", steg_method_name);
+    if (best == NULL)
+    {
+        fprintf(stderr, "Error: Ningun metodo da un bloque plausible (LSB1..LSB8, LSBI)\n");
+        if (is_encryption_enabled(config))
+            fprintf(stderr, "       (Verifica la password y los parametros)\n");
+        return OPS_EXTRACT_SIZE_FAILED;
+    }
+
+    if (ties > 0)
+    {
+        fprintf(stderr, "Aviso: Otros %zu metodos tambien son plausibles:", ties);
+        for (size_t i = 0; i < EXTRACT_AUTO_CANDIDATES; i++)
+            if (&probes[i] != best && probes[i].score == best->score)
+                fprintf(stderr, " %s", steg_method_to_string(probes[i].method));
+        fprintf(stderr, "\n");
+    }
+
+    printf("Metodo detectado: %s (bloque de %u bytes)\n", steg_method_to_string(best->method), best->size);
+    *method = best->method;
+    return OPS_OK;
+}
+
+OperationsResult perform_extract_stream(const stegobmp_config_t *config)
+{
+    BmpStream stream;
+    if (bmp_stream_open(config->carrier_file, &stream) != 0)
+    {
+        fprintf(stderr, "Error leyendo BMP (24bpp sin compresion requerido)\n");
+        return OPS_CARRIER_READ_FAILED;
+    }
+
+    size_t band_size = config->band_size ? config->band_size : STEG_STREAM_DEFAULT_BAND;
+    stegobmp_config_t resolved = *config;
+    ThreadPool *pool = thread_pool_create(config->threads);
+    OperationsResult rc = OPS_OK;
+
+    if (config->steg_method == STEG_AUTO)
+        rc = detect_extract_method(config, &stream, pool, &resolved.steg_method);
+
+    StegReader reader;
+    if (rc == OPS_OK)
+        rc = report_reader_open(&resolved, steg_reader_open_stream(&reader, &stream, resolved.steg_method,
+                                                                   band_size, pool));
+
+    if (rc == OPS_OK)
+    {
+        rc = extract_with_reader(&resolved, &reader, stream.pixelsSize);
+        steg_reader_close(&reader);
+    }
+
+    thread_pool_destroy(pool);
+    bmp_stream_close(&stream);
+    return rc;
+}
+
+OperationsResult perform_info(const stegobmp_config_t *config)
+{
+    Bmp headers;
+    BMPImage carrier;
+    if (bmp_read_headers(config->carrier_file, &headers) != 0 || convert_bmp_to_bmpimage(&headers, &carrier) != 0)
+    {
+        fprintf(stderr, "Error leyendo BMP (24bpp sin compresion requerido)\n");
+        return OPS_CARRIER_READ_FAILED;
     }
 
-    free(extracted_data);
+    size_t row_size = (carrier.width * 3 + 3) & ~(size_t)3;
+
+    printf("Portador: %s\n", config->carrier_file);
+    printf("Imagen: %zux%zu, 24 bpp, %zu bytes por fila, %zu componentes\n", carrier.width, carrier.height,
+           row_size, carrier.width * carrier.height * 3);
+    printf("Bloque oculto: 4 + archivo + extension + 1 bytes (con cifrado: 4 + largo del cifrado)\n\n");
+    printf("Metodo  Capacidad (bytes)\n");
+
+    for (size_t i = 0; i < sizeof(lsbn_methods) / sizeof(lsbn_methods[0]); i++)
+        printf("%-6s  %zu\n", steg_method_to_string(lsbn_methods[i]),
+               steg_capacity_bytes(lsbn_methods[i], carrier.width, carrier.height));
+    printf("%-6s  %zu\n", steg_method_to_string(STEG_LSBI), steg_capacity_bytes(STEG_LSBI, carrier.width, carrier.height));
+
     return OPS_OK;
-}
\ No newline at end of file
+}
+
+OperationsResult perform_operation(const stegobmp_config_t *config)
+{
+    switch (config->operation)
+    {
+        case OP_EMBED:
+            // Streaming embed: the carrier is read band by band, never loaded whole.
+            // Either way the carrier is opened while the payload is being encrypted
+            return config->stream ? perform_embed_stream(config) : perform_embed_carrier(config);
+        case OP_EXTRACT:
+            // Extract reads only the carrier rows that hold the hidden block
+            return perform_extract_stream(config);
+        default:
+            return OPS_INVALID_ARGUMENTS;
+    }
+}
+
+const char *operations_result_to_string(OperationsResult rc)
+{
+    switch (rc)
+    {
+        case OPS_OK: return "OPS_OK";
+        case OPS_INVALID_STEG_METHOD: return "OPS_INVALID_STEG_METHOD";
+        case OPS_INPUT_READ_FAILED: return "OPS_INPUT_READ_FAILED";
+        case OPS_PAYLOAD_ALLOC_FAILED: return "OPS_PAYLOAD_ALLOC_FAILED";
+        case OPS_CAPACITY_INSUFFICIENT: return "OPS_CAPACITY_INSUFFICIENT";
+        case OPS_EMBED_FAILED: return "OPS_EMBED_FAILED";
+        case OPS_BMP_WRITE_FAILED: return "OPS_BMP_WRITE_FAILED";
+        case OPS_EXTRACT_SIZE_FAILED: return "OPS_EXTRACT_SIZE_FAILED";
+        case OPS_EXTRACT_ALLOC_FAILED: return "OPS_EXTRACT_ALLOC_FAILED";
+        case OPS_EXTRACT_BLOCK_FAILED: return "OPS_EXTRACT_BLOCK_FAILED";
+        case OPS_EXTENSION_NOT_FOUND: return "OPS_EXTENSION_NOT_FOUND";
+        case OPS_OUTPUT_WRITE_FAILED: return "OPS_OUTPUT_WRITE_FAILED";
+        case OPS_ENCRYPTION_FAILED: return "OPS_ENCRYPTION_FAILED";
+        case OPS_DECRYPTION_FAILED: return "OPS_DECRYPTION_FAILED";
+        case OPS_CARRIER_READ_FAILED: return "OPS_CARRIER_READ_FAILED";
+        case OPS_INVALID_ARGUMENTS: return "OPS_INVALID_ARGUMENTS";
+        case OPS_BUFFER_TOO_SMALL: return "OPS_BUFFER_TOO_SMALL";
+        default: return "OPS_UNKNOWN";
+    }
+}
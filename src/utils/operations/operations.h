@@ -1,59 +1,85 @@
 #ifndef OPERATIONS_H
 #define OPERATIONS_H
 
-#include "../../bmp_handler/bmp_handler.h"
 #include "../parser/parser.h"
+#include "../../libstegobmp/stegobmp_types.h"
 
-typedef enum {
-    OPS_OK = 0,
-    OPS_INVALID_STEG_METHOD,
-    OPS_INPUT_READ_FAILED,
-    OPS_PAYLOAD_ALLOC_FAILED,
-    OPS_CAPACITY_INSUFFICIENT,
-    OPS_EMBED_FAILED,
-    OPS_BMP_WRITE_FAILED,
-
-    OPS_EXTRACT_SIZE_FAILED,
-    OPS_EXTRACT_ALLOC_FAILED,
-    OPS_EXTRACT_BLOCK_FAILED,
-    OPS_EXTENSION_NOT_FOUND,
-    OPS_OUTPUT_WRITE_FAILED,
-    OPS_ENCRYPTION_FAILED,
-    OPS_DECRYPTION_FAILED
-} OperationsResult;
+/**
+ * @brief Performs the embed operation, loading the carrier from config->carrier_file
+ * 
+ * Reads the input file, builds the payload (size + data + extension, encrypted
+ * when requested), embeds it with the configured steganography method and
+ * writes the output BMP (full, delta or in place). The carrier is read and
+ * validated on its own thread while the payload is read, the key is derived
+ * and the payload is encrypted; both sides meet at the embed step.
+ * 
+ * @param config Pointer to the configuration structure containing operation parameters
+ * 
+ * @return OperationsResult code indicating success or specific failure
+ * 
+ * @note Supports LSB1..LSB8, LSBI and STEG_AUTO
+ * @note With a full output the carrier pages are faulted in by the loading thread
+ */
+OperationsResult perform_embed_carrier(const stegobmp_config_t *config);
 
 /**
- * @brief Performs the embed operation
+ * @brief Performs the embed operation streaming the carrier in row bands
  * 
- * This function reads the input file, builds the payload (size + data + extension),
- * checks capacity, embeds the data using the specified steganography method,
- * and writes the output BMP file.
+ * Same payload format and output as perform_embed_carrier(), but the carrier is never
+ * loaded whole: rows are read, embedded and written band by band, so memory is
+ * bounded by config->band_size instead of the image size.
  * 
  * @param config Pointer to the configuration structure containing operation parameters
- * @param bmp Pointer to the BMP structure to embed data into
  * 
  * @return OperationsResult code indicating success or specific failure
  * 
- * @note The BMP pixel data is modified in place
- * @note Supports LSB1, LSB4, and LSBI steganography methods
+ * @note Uses STEG_STREAM_DEFAULT_BAND when config->band_size is 0
  */
-OperationsResult perform_embed(const stegobmp_config_t *config, const Bmp *bmp);
+OperationsResult perform_embed_stream(const stegobmp_config_t *config);
 
 /**
- * @brief Performs the extract operation
+ * @brief Performs the extract operation reading only the carrier prefix it needs
  * 
- * This function extracts the hidden data from a BMP file using the specified
- * steganography method, recovers the file extension, and writes the extracted
- * data to the output file.
+ * Reads just the rows holding the LSBI pattern map and the 32-bit size header,
+ * then exactly the rows that hold the hidden block, and stops. I/O is
+ * proportional to the payload instead of the image.
  * 
  * @param config Pointer to the configuration structure containing operation parameters
- * @param bmp Pointer to the BMP structure containing hidden data
  * 
  * @return OperationsResult code indicating success or specific failure
  * 
- * @note Supports LSB1, LSB4, and LSBI steganography methods
+ * @note Rows are read in bands of at most config->band_size bytes (default STEG_STREAM_DEFAULT_BAND)
+ */
+OperationsResult perform_extract_stream(const stegobmp_config_t *config);
+
+/**
+ * @brief Prints the exact capacity of config->carrier_file for every method
+ * 
+ * Only the 54 header bytes are read: capacity depends on the image size alone
+ * (see steg_capacity_bytes()).
+ * 
+ * @param config Pointer to a valid -info configuration
+ * 
+ * @return OPS_OK, or OPS_CARRIER_READ_FAILED if the headers are invalid
+ */
+OperationsResult perform_info(const stegobmp_config_t *config);
+
+/**
+ * @brief Runs the embed or extract operation described by a parsed configuration
+ * 
+ * Dispatches to perform_embed_stream()/perform_embed_carrier() or
+ * perform_extract_stream(), as the command line does.
+ * 
+ * @param config Valid embed or extract configuration
+ * 
+ * @return OperationsResult code; OPS_INVALID_ARGUMENTS for any other operation
+ */
+OperationsResult perform_operation(const stegobmp_config_t *config);
+
+/**
+ * @brief Stable name of a result code (e.g. "OPS_OK"), for machine-readable reports
  */
-OperationsResult perform_extract(const stegobmp_config_t *config, const Bmp *bmp);
+const char *operations_result_to_string(OperationsResult rc);
 
 #endif // OPERATIONS_H
 
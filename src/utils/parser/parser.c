@@ -1,4 +1,6 @@
 #include "parser.h"
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +18,13 @@ static steg_method_t parse_steg_method(const char *str) {
     if (strcmp(upper, "LSB1") == 0) return STEG_LSB1;
     if (strcmp(upper, "LSB4") == 0) return STEG_LSB4;
     if (strcmp(upper, "LSBI") == 0) return STEG_LSBI;
+    if (strcmp(upper, "LSB2") == 0) return STEG_LSB2;
+    if (strcmp(upper, "LSB3") == 0) return STEG_LSB3;
+    if (strcmp(upper, "LSB5") == 0) return STEG_LSB5;
+    if (strcmp(upper, "LSB6") == 0) return STEG_LSB6;
+    if (strcmp(upper, "LSB7") == 0) return STEG_LSB7;
+    if (strcmp(upper, "LSB8") == 0) return STEG_LSB8;
+    if (strcmp(upper, "AUTO") == 0) return STEG_AUTO;
     return STEG_NONE;
 }
 
@@ -51,15 +60,103 @@ static encryption_mode_t parse_encryption_mode(const char *str) {
     return MODE_NONE;
 }
 
+// Parses a byte size with optional K/M/G suffix, returns 0 on error
+static size_t parse_size(const char *str) {
+    char *end = NULL;
+    unsigned int shift = 0;
+
+    // Solo dígitos al inicio: strtoull aceptaría espacios y un '-' que da la vuelta
+    if (str[0] < '0' || str[0] > '9') return 0;
+
+    errno = 0;
+    unsigned long long value = strtoull(str, &end, 10);
+    if (end == str || errno == ERANGE) return 0;
+
+    switch (*end) {
+        case '\0': break;
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+        default: return 0;
+    }
+
+    if (*end != '\0' && !((end[0] == 'b' || end[0] == 'B') && end[1] == '\0')) return 0;
+
+    // Un tamaño que no entra se rechaza en lugar de dar la vuelta
+    if (value > (ULLONG_MAX >> shift)) return 0;
+    value <<= shift;
+    if (value > SIZE_MAX) return 0;
+
+    return (size_t)value;
+}
+
 // Validation logic
 static int validate_config(stegobmp_config_t *config) {
     // Check: operation must be set
     if (config->operation == OP_NONE) {
         snprintf(config->error_message, sizeof(config->error_message),
-                 "Error: Must specify either -embed or -extract");
+                 "Error: Must specify either -embed, -extract, -info, -batch or -serve");
         return -1;
     }
+
+    // Check: -batch and -serve take their jobs from the manifest or the socket;
+    // only -threads and -cache apply to them
+    if ((config->batch_file && config->operation != OP_BATCH) ||
+        (config->serve_socket && config->operation != OP_SERVE)) {
+        snprintf(config->error_message, sizeof(config->error_message),
+                 "Error: -batch and -serve cannot be combined with other operations");
+        return -9;
+    }
+    if (config->operation == OP_BATCH || config->operation == OP_SERVE) {
+        if (config->in_file || config->extension || config->carrier_file || config->out_file || config->password ||
+            config->steg_method != STEG_NONE || config->encryption_algo != ENC_NONE ||
+            config->encryption_mode != MODE_NONE || config->stream || config->output_mode != OUTPUT_FULL) {
+            snprintf(config->error_message, sizeof(config->error_message),
+                     "Error: %s only accepts -threads and -cache; job options go in each request",
+                     config->operation == OP_BATCH ? "-batch" : "-serve");
+            return -9;
+        }
+        config->is_valid = true;
+        return 0;
+    }
+
+    // Check: the carrier cache lives as long as the process, so it only helps -batch and -serve
+    if (config->cache_size || config->no_cache) {
+        snprintf(config->error_message, sizeof(config->error_message),
+                 "Error: -cache is only valid with -batch or -serve");
+        return -9;
+    }
     
+    // Check: -info only looks at the carrier headers
+    if (config->operation == OP_INFO) {
+        if (!config->carrier_file || config->in_file || config->extension || config->out_file ||
+            config->password || config->steg_method != STEG_NONE || config->encryption_algo != ENC_NONE ||
+            config->encryption_mode != MODE_NONE || config->stream || config->output_mode != OUTPUT_FULL) {
+            snprintf(config->error_message, sizeof(config->error_message),
+                     "Error: -info takes only -p <carrier>");
+            return -2;
+        }
+        config->is_valid = true;
+        return 0;
+    }
+
+    // Check: -inplace writes to the carrier, so it takes no -out
+    if (config->output_mode == OUTPUT_INPLACE) {
+        if (config->operation != OP_EMBED) {
+            snprintf(config->error_message, sizeof(config->error_message),
+                     "Error: -inplace is only valid with -embed");
+            return -8;
+        }
+        if (config->out_file) {
+            snprintf(config->error_message, sizeof(config->error_message),
+                     "Error: -inplace and -out are mutually exclusive");
+            return -8;
+        }
+        if (config->carrier_file) {
+            config->out_file = strdup(config->carrier_file);
+        }
+    }
+
     // Check: carrier and output files are required
     if (!config->carrier_file || !config->out_file) {
         snprintf(config->error_message, sizeof(config->error_message),
@@ -74,10 +171,17 @@ static int validate_config(stegobmp_config_t *config) {
         return -3;
     }
     
+    // Check: -ext names the hidden file's extension, so it only applies to embed
+    if (config->extension && config->operation != OP_EMBED) {
+        snprintf(config->error_message, sizeof(config->error_message),
+                 "Error: -ext is only valid with -embed");
+        return -3;
+    }
+    
     // Check: steg method must be valid
     if (config->steg_method == STEG_NONE) {
         snprintf(config->error_message, sizeof(config->error_message),
-                 "Error: Invalid or missing -steg method (use LSB1, LSB4, or LSBI)");
+                 "Error: Invalid or missing -steg method (use LSB1..LSB8, LSBI or auto)");
         return -4;
     }
     
@@ -120,8 +224,18 @@ int parse_arguments(int argc, char **argv, stegobmp_config_t *config) {
             config->operation = OP_EMBED;
         } else if (strcmp(argv[i], "-extract") == 0) {
             config->operation = OP_EXTRACT;
+        } else if (strcmp(argv[i], "-info") == 0) {
+            config->operation = OP_INFO;
+        } else if (strcmp(argv[i], "-batch") == 0 && i + 1 < argc) {
+            config->operation = OP_BATCH;
+            config->batch_file = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "-serve") == 0 && i + 1 < argc) {
+            config->operation = OP_SERVE;
+            config->serve_socket = strdup(argv[++i]);
         } else if (strcmp(argv[i], "-in") == 0 && i + 1 < argc) {
             config->in_file = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "-ext") == 0 && i + 1 < argc) {
+            config->extension = strdup(argv[++i]);
         } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
             config->carrier_file = strdup(argv[++i]);
         } else if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) {
@@ -134,6 +248,39 @@ int parse_arguments(int argc, char **argv, stegobmp_config_t *config) {
             config->encryption_mode = parse_encryption_mode(argv[++i]);
         } else if (strcmp(argv[i], "-pass") == 0 && i + 1 < argc) {
             config->password = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "-stream") == 0) {
+            config->stream = true;
+        } else if (strcmp(argv[i], "-band") == 0 && i + 1 < argc) {
+            config->stream = true;
+            config->band_size = parse_size(argv[++i]);
+            if (config->band_size == 0) {
+                snprintf(config->error_message, sizeof(config->error_message),
+                         "Error: Invalid -band size '%s' (use bytes or K/M/G suffix)", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            const char *value = argv[++i];
+            unsigned long threads = strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || value[0] == '-' || threads == 0) {
+                snprintf(config->error_message, sizeof(config->error_message),
+                         "Error: Invalid -threads count '%s'", value);
+                return -1;
+            }
+            config->threads = (size_t)threads;
+        } else if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc) {
+            const char *value = argv[++i];
+            config->cache_size = parse_size(value);
+            config->no_cache = strcmp(value, "0") == 0;
+            if (config->cache_size == 0 && !config->no_cache) {
+                snprintf(config->error_message, sizeof(config->error_message),
+                         "Error: Invalid -cache size '%s' (use bytes or K/M/G suffix, 0 to disable)", value);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-delta") == 0) {
+            config->output_mode = OUTPUT_DELTA;
+        } else if (strcmp(argv[i], "-inplace") == 0) {
+            config->output_mode = OUTPUT_INPLACE;
         } else {
             snprintf(config->error_message, sizeof(config->error_message),
                      "Error: Unknown option '%s'", argv[i]);
@@ -157,11 +304,91 @@ int parse_arguments(int argc, char **argv, stegobmp_config_t *config) {
     return validate_config(config);
 }
 
+static int add_argument(int *argc, char ***argv, size_t *capacity, char *arg) {
+    if ((size_t)*argc + 1 >= *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 16;
+        char **grown_argv = (char **)realloc(*argv, grown * sizeof(char *));
+        if (grown_argv == NULL) {
+            return -1;
+        }
+        *argv = grown_argv;
+        *capacity = grown;
+    }
+
+    (*argv)[(*argc)++] = arg;
+    (*argv)[*argc] = NULL;
+    return 0;
+}
+
+// Los argumentos se escriben sobre la misma línea: nunca son más largos que el texto original
+int split_arguments(char *line, int *argc, char ***argv) {
+    static char program_name[] = "stegobmp";
+    size_t capacity = 0;
+    char *r = line;
+    char *w = line;
+
+    *argc = 0;
+    *argv = NULL;
+    if (add_argument(argc, argv, &capacity, program_name) != 0) {
+        return -1;
+    }
+
+    for (;;) {
+        while (*r == ' ' || *r == '\t') {
+            r++;
+        }
+        if (*r == '\0' || *r == '#') {
+            break;
+        }
+
+        char *arg = w;
+        char quote = 0;
+
+        while (*r != '\0' && (quote || (*r != ' ' && *r != '\t'))) {
+            char c = *r++;
+
+            if (quote == '\'') {
+                if (c == '\'') quote = 0; else *w++ = c;
+            } else if (quote == '"') {
+                if (c == '"') quote = 0;
+                else if (c == '\\' && (*r == '"' || *r == '\\')) *w++ = *r++;
+                else *w++ = c;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (c == '\\' && *r != '\0') {
+                *w++ = *r++;
+            } else {
+                *w++ = c;
+            }
+        }
+
+        if (quote) {
+            return -1;
+        }
+
+        // El separador ya fue leído, así que w nunca alcanza a r
+        bool more = *r != '\0';
+        *w++ = '\0';
+        if (more) {
+            r++;
+        }
+
+        if (add_argument(argc, argv, &capacity, arg) != 0) {
+            return -1;
+        }
+    }
+
+    return *argc > 1 ? 0 : 1;
+}
+
 // Memory management
 void free_config(stegobmp_config_t *config) {
     if (config->in_file) free(config->in_file);
+    if (config->extension) free(config->extension);
     if (config->carrier_file) free(config->carrier_file);
     if (config->out_file) free(config->out_file);
+    if (config->batch_file) free(config->batch_file);
+    if (config->serve_socket) free(config->serve_socket);
     if (config->password) free(config->password);
     memset(config, 0, sizeof(stegobmp_config_t));
 }
@@ -172,10 +399,31 @@ const char* steg_method_to_string(steg_method_t method) {
         case STEG_LSB1: return "LSB1";
         case STEG_LSB4: return "LSB4";
         case STEG_LSBI: return "LSBI";
+        case STEG_LSB2: return "LSB2";
+        case STEG_LSB3: return "LSB3";
+        case STEG_LSB5: return "LSB5";
+        case STEG_LSB6: return "LSB6";
+        case STEG_LSB7: return "LSB7";
+        case STEG_LSB8: return "LSB8";
+        case STEG_AUTO: return "auto";
         default: return "NONE";
     }
 }
 
+unsigned steg_method_lsb_bits(steg_method_t method) {
+    switch (method) {
+        case STEG_LSB1: return 1;
+        case STEG_LSB2: return 2;
+        case STEG_LSB3: return 3;
+        case STEG_LSB4: return 4;
+        case STEG_LSB5: return 5;
+        case STEG_LSB6: return 6;
+        case STEG_LSB7: return 7;
+        case STEG_LSB8: return 8;
+        default: return 0;
+    }
+}
+
 const char* encryption_algo_to_string(encryption_algorithm_t algo) {
     switch (algo) {
         case ENC_AES128: return "aes128";
@@ -2,38 +2,28 @@
 #define PARSER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "../../libstegobmp/stegobmp_types.h"
 
-// Enums for type-safe configuration
+// Enums for type-safe configuration (steg_method_t and the encryption enums come from stegobmp_types.h)
 typedef enum {
-    STEG_NONE = 0,
-    STEG_LSB1,
-    STEG_LSB4,
-    STEG_LSBI
-} steg_method_t;
-
-typedef enum {
-    ENC_NONE = 0,
-    ENC_AES128,
-    ENC_AES192,
-    ENC_AES256,
-    ENC_3DES
-} encryption_algorithm_t;
-
-typedef enum {
-    MODE_NONE = 0,
-    MODE_ECB,
-    MODE_CFB,
-    MODE_OFB,
-    MODE_CBC
-} encryption_mode_t;
+    OUTPUT_FULL = 0,         // Write the whole output BMP
+    OUTPUT_DELTA,            // Clone the carrier and rewrite only the modified rows
+    OUTPUT_INPLACE           // Rewrite only the modified rows of the carrier itself
+} output_mode_t;
 
 typedef enum {
     OP_NONE = 0,
     OP_EMBED,
-    OP_EXTRACT
+    OP_EXTRACT,
+    OP_BATCH,                // Run the jobs listed in a manifest (-batch)
+    OP_SERVE,                // Serve embed/extract requests on a Unix socket (-serve)
+    OP_INFO                  // Print the carrier's capacity per method from its headers (-info)
 } operation_t;
 
+struct BmpCache;
+
 // Main configuration TAD
 typedef struct {
     // Operation mode
@@ -41,8 +31,11 @@ typedef struct {
     
     // File paths
     char *in_file;           // Input file to hide (embed only)
+    char *extension;         // Extension to record (-ext), NULL = taken from in_file
     char *carrier_file;      // Carrier BMP file
     char *out_file;          // Output file
+    char *batch_file;        // Job manifest (batch only)
+    char *serve_socket;      // Unix socket path (serve only)
     
     // Steganography configuration
     steg_method_t steg_method;
@@ -52,6 +45,15 @@ typedef struct {
     encryption_mode_t encryption_mode;
     char *password;
     
+    // Carrier I/O (optional)
+    bool stream;             // Process the carrier in row bands (-stream / -band)
+    size_t band_size;        // Band size in bytes, 0 = default
+    output_mode_t output_mode; // -delta / -inplace (out_file = carrier_file)
+    size_t threads;          // Worker threads (-threads), 0 = online CPUs
+    size_t cache_size;       // Carrier cache budget for -batch/-serve (-cache), 0 = default
+    bool no_cache;           // -cache 0: read every carrier from disk
+    struct BmpCache *carrier_cache; // Shared carrier cache set by -batch/-serve (not owned), NULL = none
+    
     // Validation and error handling
     bool is_valid;
     char error_message[256];  // Stores validation error messages
@@ -59,8 +61,13 @@ typedef struct {
 
 // Parser functions
 int parse_arguments(int argc, char **argv, stegobmp_config_t *config);
+// Splits a command line in place like a shell ('...', "...", \ escapes, # comments)
+// into argv = { "stegobmp", args..., NULL } for parse_arguments(); free(*argv) after use.
+// Returns 0, 1 if the line holds no arguments, -1 if it is malformed (unterminated quote)
+int split_arguments(char *line, int *argc, char ***argv);
 void free_config(stegobmp_config_t *config);
 const char* steg_method_to_string(steg_method_t method);
+unsigned steg_method_lsb_bits(steg_method_t method); // n for LSBn methods, 0 otherwise (LSBI)
 const char* encryption_algo_to_string(encryption_algorithm_t algo);
 const char* encryption_mode_to_string(encryption_mode_t mode);
 
@@ -0,0 +1,111 @@
+#include "payload_source.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Lee hasta EOF agrandando el buffer (pipes, FIFOs, stdin)
+static int read_chunks(int fd, PayloadSource *src) {
+    size_t capacity = PAYLOAD_SOURCE_CHUNK;
+    size_t length = 0;
+    uint8_t *buffer = (uint8_t*)malloc(capacity);
+
+    if (!buffer) 
+        return -5;
+
+    for (;;) {
+        if (length == capacity) {
+            uint8_t *grown = (uint8_t*)realloc(buffer, capacity * 2);
+
+            if (!grown) { 
+                free(buffer); 
+                return -5; 
+            }
+
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        ssize_t n = read(fd, buffer + length, capacity - length);
+
+        if (n < 0 && errno == EINTR) 
+            continue;
+
+        if (n < 0) { 
+            free(buffer); 
+            return -6; 
+        }
+
+        if (n == 0) 
+            break;
+
+        length += (size_t)n;
+    }
+
+    src->buffer = buffer;
+    src->data = length ? buffer : NULL;
+    src->length = length;
+    return 0;
+}
+
+static int map_file(int fd, size_t size, PayloadSource *src) {
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (base == MAP_FAILED) 
+        return 1;
+
+    // Se recorre una sola vez, de principio a fin
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    src->mapping = base;
+    src->mappingSize = size;
+    src->data = (const uint8_t*)base;
+    src->length = size;
+    return 0;
+}
+
+int payload_source_open(const char *path, PayloadSource *src) {
+    memset(src, 0, sizeof(*src));
+
+    bool from_stdin = strcmp(path, PAYLOAD_SOURCE_STDIN) == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+
+    if (fd < 0) 
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { 
+        if (!from_stdin) close(fd);
+        return -2; 
+    }
+
+    int rc = 1;
+    if (S_ISREG(st.st_mode)) {
+        rc = st.st_size > 0 ? map_file(fd, (size_t)st.st_size, src) : 0;
+    }
+
+    // No mapeable (pipe, FIFO, dispositivo) o mmap falló: lectura por bloques
+    if (rc > 0) {
+        rc = read_chunks(fd, src);
+    }
+
+    if (!from_stdin) 
+        close(fd);
+
+    if (rc != 0) 
+        memset(src, 0, sizeof(*src));
+
+    return rc;
+}
+
+void payload_source_close(PayloadSource *src) {
+    if (src->mapping) {
+        munmap(src->mapping, src->mappingSize);
+    }
+    free(src->buffer);
+    memset(src, 0, sizeof(*src));
+}
@@ -0,0 +1,51 @@
+#ifndef PAYLOAD_SOURCE_H
+#define PAYLOAD_SOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Path that selects standard input as the payload source */
+#define PAYLOAD_SOURCE_STDIN "-"
+
+/** Initial buffer size when reading a pipe or other non-seekable input */
+#define PAYLOAD_SOURCE_CHUNK (64u * 1024)
+
+/**
+ * @brief Read-only view of the file to hide
+ * 
+ * Regular files are mapped (no heap copy); pipes, FIFOs and standard input are
+ * read in chunks into a buffer that grows geometrically, so the size does not
+ * need to be known in advance.
+ */
+typedef struct {
+    const uint8_t *data;  /**< Payload bytes (NULL when length is 0) */
+    size_t length;        /**< Payload length in bytes */
+    uint8_t *buffer;      /**< Heap buffer for non-mappable inputs, NULL otherwise */
+    void *mapping;        /**< Base of the mapping for regular files, NULL otherwise */
+    size_t mappingSize;   /**< Size of the mapping in bytes */
+} PayloadSource;
+
+/**
+ * @brief Opens the file to hide
+ * 
+ * @param path Path of the file, or "-" for standard input
+ * @param src Source to initialize
+ * 
+ * @return 0 on success, negative error code on failure:
+ *         -1: Failed to open file
+ *         -2: Failed to stat file
+ *         -5: Memory allocation failed
+ *         -6: Failed to read file content
+ * 
+ * @note On error, src is left empty and does not need to be closed
+ */
+int payload_source_open(const char *path, PayloadSource *src);
+
+/**
+ * @brief Releases the mapping or buffer held by a source
+ * 
+ * @note Safe to call multiple times
+ */
+void payload_source_close(PayloadSource *src);
+
+#endif // PAYLOAD_SOURCE_H
@@ -0,0 +1,324 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "../../bmp_handler/bmp_cache.h"
+#include "../operations/operations.h"
+#include "../thread_pool/thread_pool.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+// El handler de señales solo toca estos dos; los workers los leen con __atomic
+static int stopping = 0;
+static int listen_fd = -1;
+
+// Cerrar la lectura del socket de escucha despierta a todos los accept() con error
+static void handle_stop(int sig)
+{
+    (void)sig;
+    __atomic_store_n(&stopping, 1, __ATOMIC_RELAXED);
+    int fd = __atomic_load_n(&listen_fd, __ATOMIC_RELAXED);
+    if (fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+typedef struct {
+    char line[SERVER_MAX_REQUEST + 1];
+    int fds[SERVER_MAX_FDS];
+    size_t fd_count;
+    bool too_many_fds;
+} server_request_t;
+
+static void close_request_fds(server_request_t *req)
+{
+    for (size_t i = 0; i < req->fd_count; i++) {
+        close(req->fds[i]);
+    }
+    req->fd_count = 0;
+}
+
+// Guarda los descriptores que llegaron con un mensaje (los que sobran se cierran)
+static void take_fds(server_request_t *req, struct msghdr *msg)
+{
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const uint8_t *data = CMSG_DATA(cmsg);
+
+        for (size_t i = 0; i < count; i++) {
+            int fd;
+            memcpy(&fd, data + i * sizeof(int), sizeof(int));
+            if (req->fd_count < SERVER_MAX_FDS) {
+                req->fds[req->fd_count++] = fd;
+            } else {
+                close(fd);
+                req->too_many_fds = true;
+            }
+        }
+    }
+}
+
+// Lee la línea del pedido (hasta '\n') junto con los descriptores que la acompañan
+static int read_request(int conn, server_request_t *req)
+{
+    size_t length = 0;
+
+    while (length < SERVER_MAX_REQUEST) {
+        union {
+            struct cmsghdr align;
+            char buf[CMSG_SPACE(sizeof(int) * SERVER_MAX_FDS)];
+        } control;
+        struct iovec iov = { req->line + length, SERVER_MAX_REQUEST - length };
+        struct msghdr msg;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+
+        take_fds(req, &msg);
+        if (msg.msg_flags & MSG_CTRUNC) {
+            req->too_many_fds = true;
+        }
+
+        char *newline = memchr(req->line + length, '\n', (size_t)n);
+        length += (size_t)n;
+        if (newline != NULL) {
+            *newline = '\0';
+            if (newline > req->line && newline[-1] == '\r') {
+                newline[-1] = '\0';
+            }
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Reemplaza cada argumento "@k" por /proc/self/fd/<k-ésimo descriptor>: abrir
+ * esa ruta reabre el mismo archivo, así que las operaciones trabajan con
+ * rutas como siempre y nada pasa por el socket.
+ */
+static int resolve_fd_arguments(int argc, char **argv, const server_request_t *req,
+                                char paths[][32])
+{
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '@' || argv[i][1] == '\0') {
+            continue;
+        }
+
+        char *end = NULL;
+        unsigned long index = strtoul(argv[i] + 1, &end, 10);
+        if (*end != '\0' || argv[i][1] == '-' || index >= req->fd_count) {
+            return -1;
+        }
+
+        snprintf(paths[index], 32, "/proc/self/fd/%d", req->fds[index]);
+        argv[i] = paths[index];
+    }
+
+    return 0;
+}
+
+static OperationsResult run_request(server_request_t *req, BmpCache *cache)
+{
+    int argc = 0;
+    char **argv = NULL;
+    char paths[SERVER_MAX_FDS][32];
+    OperationsResult rc = OPS_INVALID_ARGUMENTS;
+
+    if (req->too_many_fds) {
+        fprintf(stderr, "[serve] Error: Demasiados descriptores (maximo %d)\n", SERVER_MAX_FDS);
+        return rc;
+    }
+
+    if (split_arguments(req->line, &argc, &argv) != 0 ||
+        resolve_fd_arguments(argc, argv, req, paths) != 0) {
+        fprintf(stderr, "[serve] Error: Pedido invalido\n");
+        free(argv);
+        return rc;
+    }
+
+    stegobmp_config_t config;
+    if (parse_arguments(argc, argv, &config) != 0) {
+        fprintf(stderr, "[serve] %s\n", config.error_message);
+    } else if (config.operation != OP_EMBED && config.operation != OP_EXTRACT) {
+        fprintf(stderr, "[serve] Error: Solo se aceptan pedidos -embed o -extract\n");
+    } else {
+        // Los pedidos ya corren en paralelo: sin -threads cada uno usa un solo hilo
+        if (config.threads == 0) {
+            config.threads = 1;
+        }
+        config.carrier_cache = cache;
+        rc = perform_operation(&config);
+    }
+
+    free_config(&config);
+    free(argv);
+    return rc;
+}
+
+static void handle_connection(int conn, BmpCache *cache)
+{
+    server_request_t req;
+    memset(&req, 0, sizeof(req));
+
+    // Un cliente que no termina de mandar su pedido no retiene al worker para siempre
+    struct timeval timeout = { SERVER_RECV_TIMEOUT, 0 };
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    OperationsResult rc = OPS_INVALID_ARGUMENTS;
+    if (read_request(conn, &req) == 0) {
+        rc = run_request(&req, cache);
+    } else {
+        fprintf(stderr, "[serve] Error: Pedido incompleto o demasiado largo\n");
+    }
+    close_request_fds(&req);
+
+    char reply[64];
+    int length = snprintf(reply, sizeof(reply), "%d\t%s\n", (int)rc, operations_result_to_string(rc));
+    if (send(conn, reply, (size_t)length, MSG_NOSIGNAL) < 0) {
+        fprintf(stderr, "[serve] Error: No pude responder al cliente\n");
+    }
+    close(conn);
+}
+
+// Cada worker atiende conexiones hasta que se cierra el socket de escucha
+static void serve_worker(void *arg, size_t index)
+{
+    BmpCache *cache = (BmpCache *)arg;
+    (void)index;
+
+    while (!__atomic_load_n(&stopping, __ATOMIC_RELAXED)) {
+        int conn = accept4(__atomic_load_n(&listen_fd, __ATOMIC_RELAXED), NULL, NULL, SOCK_CLOEXEC);
+        if (conn < 0) {
+            // EINVAL: el socket de escucha se cerró (parada)
+            if (__atomic_load_n(&stopping, __ATOMIC_RELAXED) || errno == EINVAL || errno == EBADF) {
+                break;
+            }
+            // Sin descriptores o memoria por un momento: se reintenta sin perder el worker
+            if (errno != EINTR && errno != ECONNABORTED) {
+                usleep(10000);
+            }
+            continue;
+        }
+        handle_connection(conn, cache);
+    }
+}
+
+static int open_listen_socket(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Ruta de socket demasiado larga '%s'\n", path);
+        return -1;
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    // Un socket viejo de una ejecución anterior se reemplaza; cualquier otro archivo no
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Error: '%s' existe y no es un socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: No pude crear el socket\n");
+        return -1;
+    }
+
+    mode_t old_mask = umask(0077);
+    int bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+
+    if (bound != 0 || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: No pude escuchar en '%s'\n", path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int server_run(const stegobmp_config_t *config)
+{
+    int fd = open_listen_socket(config->serve_socket);
+    if (fd < 0) {
+        return -1;
+    }
+
+    ThreadPool *pool = thread_pool_create(config->threads);
+    size_t workers = thread_pool_size(pool);
+
+    __atomic_store_n(&stopping, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&listen_fd, fd, __ATOMIC_RELAXED);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Los mensajes de progreso de los pedidos no van a ningún lado; los errores siguen en stderr
+    fflush(stdout);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+
+    fprintf(stderr, "[serve] Escuchando en %s (%zu workers)\n", config->serve_socket, workers);
+
+    BmpCache *cache = NULL;
+    if (!config->no_cache) {
+        cache = bmp_cache_create(config->cache_size ? config->cache_size : BMP_CACHE_DEFAULT_BUDGET);
+    }
+
+    thread_pool_run(pool, serve_worker, cache, workers);
+    thread_pool_destroy(pool);
+
+    if (cache != NULL) {
+        size_t hits, misses;
+        bmp_cache_stats(cache, &hits, &misses);
+        fprintf(stderr, "[cache] %zu aciertos, %zu lecturas de portador\n", hits, misses);
+        bmp_cache_destroy(cache);
+    }
+
+    __atomic_store_n(&listen_fd, -1, __ATOMIC_RELAXED);
+    close(fd);
+    unlink(config->serve_socket);
+
+    fprintf(stderr, "[serve] Detenido\n");
+    return 0;
+}
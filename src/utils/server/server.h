@@ -0,0 +1,50 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "../parser/parser.h"
+
+/**
+ * @file server.h
+ * @brief Long-running process answering embed/extract requests on a Unix socket
+ *
+ * Keeps one warm process (OpenSSL, kernel dispatch and worker threads already
+ * set up) instead of one exec per file. Each connection carries one request:
+ *
+ * - client -> server: one line of command-line options, split like a -batch
+ *   manifest line and terminated by '\n' (at most SERVER_MAX_REQUEST bytes).
+ *   Up to SERVER_MAX_FDS open descriptors may travel with it as SCM_RIGHTS;
+ *   an argument "@k" names the k-th of them, so files are passed without
+ *   copying their contents over the socket:
+ *
+ *       -embed -in @0 -ext .pdf -p @1 -out @2 -steg LSB4
+ *
+ * - server -> client: "<code>\t<name>\n" with the request's OperationsResult
+ *   (see operations_result_to_string()), then the connection is closed.
+ *
+ * Requests run on a fixed pool of workers; each one uses a single thread for
+ * the kernels unless it says otherwise with -threads, and carriers are shared
+ * through one BmpCache for the life of the server. SIGINT or SIGTERM stop
+ * accepting, let the running requests finish and remove the socket.
+ */
+
+/** Longest request line, in bytes (newline included) */
+#define SERVER_MAX_REQUEST 4096
+
+/** Most descriptors accepted with one request */
+#define SERVER_MAX_FDS 8
+
+/** Seconds a client has to send its request before the connection is dropped */
+#define SERVER_RECV_TIMEOUT 10
+
+/**
+ * @brief Listens on config->serve_socket and serves requests until SIGINT/SIGTERM
+ *
+ * @param config Serve configuration; config->threads workers (0 = online CPUs)
+ *
+ * @return 0 after a clean shutdown, -1 if the socket could not be set up
+ *
+ * @note The socket is created with mode 0600: requests run with the server's permissions
+ */
+int server_run(const stegobmp_config_t *config);
+
+#endif // SERVER_H
@@ -0,0 +1,149 @@
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct ThreadPool {
+    pthread_t *workers;
+    size_t worker_count;        // Hilos propios; el que llama a thread_pool_run() también trabaja
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;       // Hay un trabajo nuevo (o hay que terminar)
+    pthread_cond_t done;        // El último worker terminó el trabajo actual
+    unsigned long generation;   // Trabajos publicados hasta ahora
+    bool stopping;
+
+    thread_pool_task_fn fn;
+    void *arg;
+    size_t tasks;
+    size_t next;                // Próximo índice a repartir (atómico)
+    size_t busy;                // Workers que todavía no terminaron el trabajo actual
+};
+
+// Toma índices hasta que no queden tareas del trabajo actual
+static void run_tasks(ThreadPool *pool) {
+    for (;;) {
+        size_t index = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (index >= pool->tasks) {
+            break;
+        }
+        pool->fn(pool->arg, index);
+    }
+}
+
+static void *worker_main(void *p) {
+    ThreadPool *pool = (ThreadPool *)p;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tasks(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+size_t thread_pool_online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+}
+
+ThreadPool *thread_pool_create(size_t threads) {
+    if (threads == 0) {
+        threads = thread_pool_online_cpus();
+    }
+
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    if (threads > 1) {
+        pool->workers = (pthread_t *)calloc(threads - 1, sizeof(pthread_t));
+        if (pool->workers == NULL) {
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    for (size_t i = 0; i + 1 < threads; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+        pool->worker_count++;
+    }
+
+    return pool;
+}
+
+size_t thread_pool_size(const ThreadPool *pool) {
+    return pool == NULL ? 1 : pool->worker_count + 1;
+}
+
+void thread_pool_run(ThreadPool *pool, thread_pool_task_fn fn, void *arg, size_t tasks) {
+    if (pool == NULL || pool->worker_count == 0 || tasks <= 1) {
+        for (size_t i = 0; i < tasks; i++) {
+            fn(arg, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->tasks = tasks;
+    pool->next = 0;
+    pool->busy = pool->worker_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_tasks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(ThreadPool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
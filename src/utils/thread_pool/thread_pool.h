@@ -0,0 +1,62 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @file thread_pool.h
+ * @brief Fixed pool of worker threads running parallel-for jobs
+ *
+ * A job is a function called once per task index; tasks are handed out to the
+ * workers and to the calling thread, and thread_pool_run() returns when all of
+ * them finished. Jobs run one at a time.
+ */
+
+typedef struct ThreadPool ThreadPool;
+
+/** Task body: called once for each index in [0, tasks) */
+typedef void (*thread_pool_task_fn)(void *arg, size_t index);
+
+/**
+ * @brief Creates a pool that runs jobs on `threads` threads (the caller included)
+ *
+ * @param threads Total threads per job; 0 uses the number of online CPUs
+ *
+ * @return The new pool, or NULL on failure
+ */
+ThreadPool *thread_pool_create(size_t threads);
+
+/**
+ * @brief Number of threads (caller included) that run each job
+ *
+ * @param pool Thread pool, may be NULL
+ *
+ * @return Thread count, 1 for a NULL pool
+ */
+size_t thread_pool_size(const ThreadPool *pool);
+
+/**
+ * @brief Runs fn(arg, i) for every i in [0, tasks) and waits for all of them
+ *
+ * @param pool Thread pool; NULL runs every task on the calling thread
+ * @param fn Task body
+ * @param arg Argument passed to every task
+ * @param tasks Number of tasks
+ *
+ * @note Tasks must not call thread_pool_run() on the same pool
+ */
+void thread_pool_run(ThreadPool *pool, thread_pool_task_fn fn, void *arg, size_t tasks);
+
+/**
+ * @brief Stops the workers and frees the pool
+ *
+ * @param pool Thread pool, may be NULL
+ */
+void thread_pool_destroy(ThreadPool *pool);
+
+/**
+ * @brief Number of online CPUs (at least 1)
+ */
+size_t thread_pool_online_cpus(void);
+
+#endif // THREAD_POOL_H